@@ -12,7 +12,9 @@ Edits Pinecone's current OG Xbox JSON structure:
       "Content IDs": ["<contentid16hex_lower>", ...],                 # DLC content ids
       "Title Updates": ["<tuid16hex_lower>", ...],                    # TU ids
       "Title Updates Known": [ { "<sha1>": "<tuid>:<label>", ... } ], # optional, list length 0 or 1
-      "Archived": [ { "<contentid>": "<dlc name>", ... } ]            # optional, list length 0 or 1
+      "Archived": [ { "<contentid>": "<dlc name>", ... } ],           # optional, list length 0 or 1
+      "Title Update Sizes": { "<sha1>": <file size in bytes>, ... },  # optional, lets the scanner skip hashing
+      "Content Fingerprints": { "<contentid>": "<fingerprint>", ... } # optional, checked by pinecone -fingerprint
     },
     ...
   }
@@ -23,6 +25,8 @@ Icon behavior:
 - If missing, downloads from MobCat GitHub raw and stores locally:
   https://raw.githubusercontent.com/MobCat/MobCats-original-xbox-game-list/main/icon/<TID[:4]>/<TID>.png
 - Cache defaults to: <json_dir>/data/icons/
+- Downloads run on a small pool of threads with kept-alive connections;
+  cached icons are revalidated (ETag / Last-Modified) after a week.
 - Includes Tools:
   - Set Icon Cache Folder…
   - Prefetch Missing Icons…
@@ -37,7 +41,9 @@ import time
 import hashlib
 import re
 import threading
-import urllib.request
+import http.client
+import urllib.parse
+from concurrent.futures import ThreadPoolExecutor, Future, as_completed
 from dataclasses import dataclass, field
 from typing import Dict, Any, Optional, List, Tuple
 
@@ -147,27 +153,184 @@ def mobcat_icon_url(title_id_hex_8: str) -> str:
     prefix = tid[:4]
     return f"{MOBcat_RAW_BASE}/{prefix}/{tid}.png"
 
-def download_to_file(url: str, out_path: str, timeout: int = 12) -> bool:
-    try:
-        req = urllib.request.Request(
-            url,
-            headers={"User-Agent": "PineconeOGXboxEditor/1.0 (+https://github.com/MrMilenko/Pinecone)"}
-        )
-        with urllib.request.urlopen(req, timeout=timeout) as r:
-            data = r.read()
+ICON_FETCH_WORKERS = 8                 # concurrent icon downloads
+ICON_SELECTED_WORKERS = 1              # extra workers for the selected title, never busy with prefetches
+ICON_TIMEOUT = 12                      # seconds per request
+ICON_REVALIDATE_AFTER = 7 * 24 * 3600  # seconds before a cached icon is checked again
+ICON_USER_AGENT = "PineconeOGXboxEditor/1.0 (+https://github.com/MrMilenko/Pinecone)"
 
-        # sanity
-        if not data or len(data) < 256:
-            return False
-        if b"<html" in data[:512].lower():
-            return False
+# IconFetcher.fetch results
+ICON_FETCHED = "fetched"              # downloaded (new or changed)
+ICON_NOT_MODIFIED = "not-modified"    # revalidated, cached copy is current
+ICON_FRESH = "fresh"                  # checked recently, no request made
+ICON_MISSING = "missing"              # MobCat has no icon for the title
+ICON_FAILED = "failed"                # network or server error
 
-        ensure_dir(os.path.dirname(out_path))
-        with open(out_path, "wb") as f:
-            f.write(data)
-        return True
+def icon_meta_path(cache_dir: str, title_id_hex_8: str) -> str:
+    """
+    Sidecar of a cached icon: the ETag / Last-Modified it was served with and
+    when it was last checked. Titles without an icon on MobCat only have one.
+    """
+    return os.path.join(cache_dir, f"{title_id_hex_8.lower()}.meta.json")
+
+def load_icon_meta(cache_dir: str, tid: str) -> Dict[str, Any]:
+    try:
+        with open(icon_meta_path(cache_dir, tid), "r", encoding="utf-8") as f:
+            meta = json.load(f)
+        return meta if isinstance(meta, dict) else {}
     except Exception:
-        return False
+        return {}
+
+def save_icon_meta(cache_dir: str, tid: str, meta: Dict[str, Any]) -> None:
+    p = icon_meta_path(cache_dir, tid)
+    tmp = f"{p}.tmp-{threading.get_ident()}"
+    with open(tmp, "w", encoding="utf-8") as f:
+        json.dump(meta, f)
+    os.replace(tmp, p)
+
+def icon_data_ok(data: bytes) -> bool:
+    # sanity: not an empty body or an HTML error page
+    return bool(data) and len(data) >= 256 and b"<html" not in data[:512].lower()
+
+class _IconJob:
+    """One fetch of one icon, shared by every caller that asks for it meanwhile."""
+
+    def __init__(self, force: bool):
+        self.future: Future = Future()
+        self.force = force
+        self.started = False
+
+
+class IconFetcher:
+    """
+    Downloads MobCat icons on a bounded pool of worker threads.
+
+    - Each worker keeps its HTTPS connection open between requests.
+    - A title already being fetched is not requested again; callers share
+      its Future.
+    - The selected title has workers of its own, so it never waits behind
+      a prefetch of the whole database.
+    - Cached icons are revalidated with If-None-Match / If-Modified-Since
+      once ICON_REVALIDATE_AFTER has passed, so a current cache costs a 304
+      per icon rather than a download, and nothing at all in between.
+    """
+
+    def __init__(self, workers: int = ICON_FETCH_WORKERS, selected_workers: int = ICON_SELECTED_WORKERS):
+        self._pool = ThreadPoolExecutor(max_workers=workers, thread_name_prefix="icon")
+        self._selected = ThreadPoolExecutor(max_workers=selected_workers, thread_name_prefix="icon-selected")
+        self._local = threading.local()
+        self._lock = threading.Lock()
+        self._inflight: Dict[Tuple[str, str], _IconJob] = {}  # (cache_dir, tid) -> job
+
+    def fetch(self, cache_dir: str, title_id_8: str, force: bool = False, selected: bool = False) -> Future:
+        """
+        Makes sure the icon of title_id_8 in cache_dir is present and current.
+        The Future resolves to one of the ICON_* results. force revalidates
+        even a recently checked icon; selected runs the fetch on the
+        selection's workers, ahead of queued prefetches.
+        """
+        tid = norm_hex(title_id_8, width=8, lower=True)
+        key = (cache_dir, tid)
+        with self._lock:
+            job = self._inflight.get(key)
+            if job is not None and force and not job.force:
+                if job.started:
+                    # an unforced check may skip the request; run a forced one too
+                    job = None
+                else:
+                    job.force = True
+            if job is None:
+                job = self._inflight[key] = _IconJob(force)
+                (self._selected if selected else self._pool).submit(self._run_job, job, key)
+            elif selected and not job.started:
+                # queued behind prefetches: whichever worker gets to it first runs it
+                self._selected.submit(self._run_job, job, key)
+        return job.future
+
+    def _run_job(self, job: _IconJob, key: Tuple[str, str]) -> None:
+        with self._lock:
+            if job.started:
+                return
+            job.started = True
+            force = job.force
+        result = self._run(key[0], key[1], force)
+        with self._lock:
+            if self._inflight.get(key) is job:
+                del self._inflight[key]
+        job.future.set_result(result)
+
+    def _get(self, url: str, headers: Dict[str, str]) -> Tuple[int, http.client.HTTPResponse, bytes]:
+        u = urllib.parse.urlsplit(url)
+        conns = getattr(self._local, "conns", None)
+        if conns is None:
+            conns = self._local.conns = {}
+        # A kept-alive connection may have been closed by the server since
+        # its last request; retry once on a new one.
+        for attempt in (0, 1):
+            conn = conns.get(u.netloc)
+            if conn is None:
+                conn = conns[u.netloc] = http.client.HTTPSConnection(u.netloc, timeout=ICON_TIMEOUT)
+            try:
+                conn.request("GET", u.path, headers=headers)
+                r = conn.getresponse()
+                return r.status, r, r.read()
+            except (http.client.HTTPException, OSError):
+                conn.close()
+                del conns[u.netloc]
+                if attempt:
+                    raise
+        raise AssertionError("unreachable")
+
+    def _run(self, cache_dir: str, tid: str, force: bool) -> str:
+        try:
+            return self._fetch(cache_dir, tid, force)
+        except Exception:
+            return ICON_FAILED
+
+    def _fetch(self, cache_dir: str, tid: str, force: bool) -> str:
+        p = icon_cache_path(cache_dir, tid)
+        have = os.path.exists(p)
+        meta = load_icon_meta(cache_dir, tid)
+        # icons cached before sidecars existed count as checked when written
+        checked = meta.get("checked") or (os.path.getmtime(p) if have else 0)
+        if not force and (have or meta.get("missing")) and time.time() - checked < ICON_REVALIDATE_AFTER:
+            return ICON_FRESH if have else ICON_MISSING
+
+        headers = {"User-Agent": ICON_USER_AGENT}
+        if have and meta.get("etag"):
+            headers["If-None-Match"] = meta["etag"]
+        if have and meta.get("last_modified"):
+            headers["If-Modified-Since"] = meta["last_modified"]
+        try:
+            status, r, data = self._get(mobcat_icon_url(tid), headers)
+        except Exception:
+            return ICON_FAILED
+
+        try:
+            if status == 304 and have:
+                meta["checked"] = time.time()
+                save_icon_meta(cache_dir, tid, meta)
+                return ICON_NOT_MODIFIED
+            if status == 404:
+                # keep a copy MobCat no longer has
+                save_icon_meta(cache_dir, tid, {"missing": not have, "checked": time.time()})
+                return ICON_NOT_MODIFIED if have else ICON_MISSING
+            if status != 200 or not icon_data_ok(data):
+                return ICON_FAILED
+
+            ensure_dir(cache_dir)
+            tmp = f"{p}.tmp-{threading.get_ident()}"
+            with open(tmp, "wb") as f:
+                f.write(data)
+            os.replace(tmp, p)
+            save_icon_meta(cache_dir, tid, {
+                "etag": r.getheader("ETag") or "",
+                "last_modified": r.getheader("Last-Modified") or "",
+                "checked": time.time(),
+            })
+            return ICON_FETCHED
+        except OSError:
+            return ICON_FAILED
 
 
 # ---------------------------
@@ -182,6 +345,8 @@ class TitleRecord:
     title_updates: List[str] = field(default_factory=list) # 16 hex lower
     tu_known: Dict[str, str] = field(default_factory=dict) # sha1(lower) -> label
     archived: Dict[str, str] = field(default_factory=dict) # contentid(lower) -> name
+    tu_sizes: Dict[str, int] = field(default_factory=dict) # sha1(lower) -> file size
+    fingerprints: Dict[str, str] = field(default_factory=dict) # contentid(lower) -> content fingerprint
 
     @staticmethod
     def from_json(title_id: str, obj: Dict[str, Any]) -> "TitleRecord":
@@ -221,6 +386,23 @@ class TitleRecord:
             if cid_n:
                 archived_norm[cid_n] = str(label)
 
+        tu_sizes = {}
+        sizes = obj.get("Title Update Sizes", {})
+        if isinstance(sizes, dict):
+            for sha1, size in sizes.items():
+                sha1_n = norm_hex(sha1, width=40, lower=True)
+                if sha1_n and isinstance(size, int) and size >= 0:
+                    tu_sizes[sha1_n] = size
+
+        fingerprints = {}
+        fps = obj.get("Content Fingerprints", {})
+        if isinstance(fps, dict):
+            for cid, fp in fps.items():
+                cid_n = norm_hex(cid, width=16, lower=True)
+                fp_n = norm_hex(fp, width=40, lower=True)
+                if cid_n and fp_n:
+                    fingerprints[cid_n] = fp_n
+
         # de-dupe / normalize lists
         content_ids = sorted(set(content_ids))
         title_updates = sorted(set(title_updates))
@@ -232,6 +414,8 @@ class TitleRecord:
             title_updates=title_updates,
             tu_known=tu_known_norm,
             archived=archived_norm,
+            tu_sizes=tu_sizes,
+            fingerprints=fingerprints,
         )
 
     def to_json_obj(self) -> Dict[str, Any]:
@@ -262,14 +446,160 @@ class TitleRecord:
             if d:
                 obj["Archived"] = [d]
 
+        # optional; only written for known SHA1s so removed entries don't linger
+        sizes = {}
+        for sha1, size in self.tu_sizes.items():
+            sha1_n = norm_hex(sha1, width=40, lower=True)
+            if sha1_n in self.tu_known:
+                sizes[sha1_n] = int(size)
+        if sizes:
+            obj["Title Update Sizes"] = dict(sorted(sizes.items()))
+
+        # optional; only written for listed ContentIDs, like the sizes above
+        fps = {}
+        for cid, fp in self.fingerprints.items():
+            cid_n = norm_hex(cid, width=16, lower=True)
+            if cid_n in self.content_ids and fp:
+                fps[cid_n] = norm_hex(fp, width=40, lower=True)
+        if fps:
+            obj["Content Fingerprints"] = dict(sorted(fps.items()))
+
         return obj
 
 
+def title_display(tr: TitleRecord) -> str:
+    return f"{tr.title_name} ({tr.title_id})" if tr.title_name else tr.title_id
+
+def validate_title(tid: str, tr: TitleRecord) -> List[str]:
+    """
+    Issues of one title, as listed by Tools > Validate.
+    """
+    issues = []
+    if len(tid) != 8 or not is_hex(tid):
+        issues.append(f"{tid}: TitleID invalid")
+
+    content_ids = set(tr.content_ids)
+    for cid in tr.content_ids:
+        if len(cid) != 16 or not is_hex(cid):
+            issues.append(f"{tid} '{tr.title_name}': ContentID invalid: {cid}")
+        if not cid.startswith(tid):
+            issues.append(f"{tid} '{tr.title_name}': ContentID does not start with TitleID: {cid}")
+
+    for cid in tr.archived.keys():
+        if len(cid) != 16 or not is_hex(cid):
+            issues.append(f"{tid} '{tr.title_name}': Archived ContentID invalid: {cid}")
+        if cid not in content_ids:
+            issues.append(f"{tid} '{tr.title_name}': Archived entry not in Content IDs: {cid}")
+
+    for cid, fp in tr.fingerprints.items():
+        if len(fp) != 40 or not is_hex(fp):
+            issues.append(f"{tid} '{tr.title_name}': Fingerprint invalid for {cid}: {fp}")
+        if cid not in content_ids:
+            issues.append(f"{tid} '{tr.title_name}': Fingerprint recorded for ContentID not in Content IDs: {cid}")
+
+    for tu in tr.title_updates:
+        if len(tu) != 16 or not is_hex(tu):
+            issues.append(f"{tid} '{tr.title_name}': TU invalid: {tu}")
+
+    for sha1, val in tr.tu_known.items():
+        if len(sha1) != 40 or not is_hex(sha1):
+            issues.append(f"{tid} '{tr.title_name}': Known SHA1 invalid: {sha1}")
+        if val is None:
+            issues.append(f"{tid} '{tr.title_name}': Known SHA1 has empty value: {sha1}")
+
+    for sha1 in tr.tu_sizes.keys():
+        if sha1 not in tr.tu_known:
+            issues.append(f"{tid} '{tr.title_name}': Size recorded for SHA1 not in Title Updates Known: {sha1}")
+    return issues
+
+
+class TitleSearchIndex:
+    """
+    Substring search over title IDs and names (the title list's display
+    text, lowercased). Every title is indexed by the trigrams of its text: a
+    query of three or more characters only checks the titles holding all of
+    its trigrams, and a query extending the previous one only the previous
+    matches. Results are title IDs in sorted order, like the list.
+    """
+
+    def __init__(self):
+        self._display: Dict[str, str] = {}      # tid -> display text
+        self._text: Dict[str, str] = {}         # tid -> lowercased display text
+        self._grams: Dict[str, set] = {}        # trigram -> tids
+        self._sorted: Optional[List[str]] = None
+        self._last: Optional[Tuple[str, List[str]]] = None  # previous query and result
+
+    @staticmethod
+    def _trigrams(text: str) -> set:
+        return {text[i:i + 3] for i in range(len(text) - 2)}
+
+    def rebuild(self, titles: Dict[str, TitleRecord]) -> None:
+        self._display.clear()
+        self._text.clear()
+        self._grams.clear()
+        for tid, tr in titles.items():
+            self.update(tid, tr)
+
+    def update(self, tid: str, tr: TitleRecord) -> None:
+        display = title_display(tr)
+        if self._display.get(tid) == display:
+            return
+        self.remove(tid)
+        text = display.lower()
+        self._display[tid] = display
+        self._text[tid] = text
+        for g in self._trigrams(text):
+            self._grams.setdefault(g, set()).add(tid)
+        self._sorted = None
+        self._last = None
+
+    def remove(self, tid: str) -> None:
+        text = self._text.pop(tid, None)
+        if text is None:
+            return
+        del self._display[tid]
+        for g in self._trigrams(text):
+            tids = self._grams.get(g)
+            if tids is not None:
+                tids.discard(tid)
+                if not tids:
+                    del self._grams[g]
+        self._sorted = None
+        self._last = None
+
+    def display(self, tid: str) -> str:
+        return self._display.get(tid, tid)
+
+    def query(self, q: str) -> List[str]:
+        q = q.lower().strip()
+        if self._sorted is None:
+            self._sorted = sorted(self._text)
+        if not q:
+            return self._sorted
+
+        if self._last is not None and q.startswith(self._last[0]):
+            result = [tid for tid in self._last[1] if q in self._text[tid]]
+        elif len(q) >= 3:
+            sets = sorted((self._grams.get(g, set()) for g in self._trigrams(q)), key=len)
+            candidates = set.intersection(*sets) if sets[0] else set()
+            result = sorted(tid for tid in candidates if q in self._text[tid])
+        else:
+            result = [tid for tid in self._sorted if q in self._text[tid]]
+        self._last = (q, result)
+        return result
+
+
 class IdDatabaseModel:
     def __init__(self):
         self.path: Optional[str] = None
         self.dirty: bool = False
         self.titles: Dict[str, TitleRecord] = {}  # key = titleid8hex lower
+        self.search = TitleSearchIndex()
+
+        # validation state: issues per title from the last pass, and the
+        # titles edited (or loaded) since, which the next pass re-checks
+        self._issues: Dict[str, List[str]] = {}
+        self._unvalidated: set = set()
 
     def load(self, path: str):
         with open(path, "r", encoding="utf-8") as f:
@@ -288,6 +618,9 @@ class IdDatabaseModel:
         self.titles = out
         self.path = path
         self.dirty = False
+        self.search.rebuild(out)
+        self._issues = {}
+        self._unvalidated = set(out)
 
     def save(self, path: Optional[str] = None):
         if path is None:
@@ -316,8 +649,37 @@ class IdDatabaseModel:
         self.path = path
         self.dirty = False
 
-    def mark_dirty(self):
+    def mark_dirty(self, *title_ids: str):
+        """
+        Records an edit of the given titles (all of them if none are given):
+        they are re-indexed for search and re-checked by the next validate.
+        Pass every title ID an edit touched, including the old ID of a
+        renamed title.
+        """
         self.dirty = True
+        for tid in title_ids or list(self.titles):
+            tr = self.titles.get(tid)
+            if tr is None:
+                self.search.remove(tid)
+            else:
+                self.search.update(tid, tr)
+            self._unvalidated.add(tid)
+
+    def validate(self) -> Tuple[List[str], int]:
+        """
+        Re-checks the titles edited since the last pass and returns the
+        issues of the whole database, with the number of titles checked.
+        """
+        checked = 0
+        for tid in self._unvalidated:
+            tr = self.titles.get(tid)
+            if tr is None:
+                self._issues.pop(tid, None)
+            else:
+                self._issues[tid] = validate_title(tid, tr)
+                checked += 1
+        self._unvalidated.clear()
+        return [issue for tid in sorted(self._issues) for issue in self._issues[tid]], checked
 
     def ensure_title(self, title_id: str) -> TitleRecord:
         tid = norm_hex(title_id, width=8, lower=True)
@@ -325,7 +687,7 @@ class IdDatabaseModel:
             raise ValueError("TitleID must be 8 hex characters")
         if tid not in self.titles:
             self.titles[tid] = TitleRecord(title_id=tid, title_name="")
-            self.mark_dirty()
+            self.mark_dirty(tid)
         return self.titles[tid]
 
 
@@ -341,12 +703,13 @@ class IdDatabaseEditor(ttk.Frame):
 
         # selection state
         self._selected_title_id: Optional[str] = None
+        self._visible_ids: List[str] = []  # title IDs in the list, in order
 
         # icon state
         self.icon_cache_dir: Optional[str] = None
         self._icon_photo: Optional[tk.PhotoImage] = None
         self._icon_mem: Dict[str, tk.PhotoImage] = {}          # tid -> PhotoImage
-        self._icon_fetch_inflight: set[str] = set()            # tid
+        self._icons = IconFetcher()                            # downloads, shared by selection and prefetch
         self._placeholder_photo: Optional[tk.PhotoImage] = None
 
         self._build_ui()
@@ -466,9 +829,11 @@ class IdDatabaseEditor(ttk.Frame):
         self.var_detail_id = tk.StringVar()
         self.var_detail_name = tk.StringVar()
         self.var_detail_archived = tk.BooleanVar(value=False)
+        self.var_detail_fingerprint = tk.StringVar()
 
         self.var_known_sha1 = tk.StringVar()
         self.var_known_value = tk.StringVar()
+        self.var_known_size = tk.StringVar()
 
         ttk.Label(self.details, text="ID (hex):").grid(row=0, column=0, sticky="e", padx=6, pady=6)
         self.ent_detail_id = ttk.Entry(self.details, textvariable=self.var_detail_id)
@@ -481,21 +846,30 @@ class IdDatabaseEditor(ttk.Frame):
         self.chk_archived = ttk.Checkbutton(self.details, text="Archived (stores DLC name in Archived map)", variable=self.var_detail_archived)
         self.chk_archived.grid(row=2, column=0, columnspan=2, sticky="w", padx=6, pady=6)
 
-        ttk.Separator(self.details, orient="horizontal").grid(row=3, column=0, columnspan=2, sticky="we", padx=6, pady=6)
+        ttk.Label(self.details, text="Fingerprint (40-hex):").grid(row=3, column=0, sticky="e", padx=6, pady=6)
+        self.ent_detail_fingerprint = ttk.Entry(self.details, textvariable=self.var_detail_fingerprint)
+        self.ent_detail_fingerprint.grid(row=3, column=1, sticky="we", padx=6, pady=6)
+
+        ttk.Separator(self.details, orient="horizontal").grid(row=4, column=0, columnspan=2, sticky="we", padx=6, pady=6)
 
-        ttk.Label(self.details, text="SHA1 (40-hex):").grid(row=4, column=0, sticky="e", padx=6, pady=6)
+        ttk.Label(self.details, text="SHA1 (40-hex):").grid(row=5, column=0, sticky="e", padx=6, pady=6)
         self.ent_known_sha1 = ttk.Entry(self.details, textvariable=self.var_known_sha1)
-        self.ent_known_sha1.grid(row=4, column=1, sticky="we", padx=6, pady=6)
+        self.ent_known_sha1.grid(row=5, column=1, sticky="we", padx=6, pady=6)
 
-        ttk.Label(self.details, text="Value:").grid(row=5, column=0, sticky="e", padx=6, pady=6)
+        ttk.Label(self.details, text="Value:").grid(row=6, column=0, sticky="e", padx=6, pady=6)
         self.ent_known_value = ttk.Entry(self.details, textvariable=self.var_known_value)
-        self.ent_known_value.grid(row=5, column=1, sticky="we", padx=6, pady=6)
+        self.ent_known_value.grid(row=6, column=1, sticky="we", padx=6, pady=6)
+
+        ttk.Label(self.details, text="Size (bytes):").grid(row=7, column=0, sticky="e", padx=6, pady=6)
+        self.ent_known_size = ttk.Entry(self.details, textvariable=self.var_known_size)
+        self.ent_known_size.grid(row=7, column=1, sticky="we", padx=6, pady=6)
 
         btns = ttk.Frame(self.details)
-        btns.grid(row=6, column=0, columnspan=2, sticky="we", padx=6, pady=(6, 6))
+        btns.grid(row=8, column=0, columnspan=2, sticky="we", padx=6, pady=(6, 6))
         ttk.Button(btns, text="Apply Changes", command=self.action_apply_entry).pack(side="left", padx=4)
         ttk.Button(btns, text="Delete Selected", command=self.action_delete_selected).pack(side="left", padx=4)
         ttk.Button(btns, text="Compute SHA1 → Known Value…", command=self.action_compute_sha1_to_known).pack(side="left", padx=4)
+        ttk.Button(btns, text="Fingerprint DLC Folder…", command=self.action_compute_fingerprint).pack(side="left", padx=4)
 
         self.pack(fill="both", expand=True)
 
@@ -595,7 +969,8 @@ class IdDatabaseEditor(ttk.Frame):
 
     def _load_icon_for_title(self, title_id_8: str) -> None:
         """
-        Loads from memory/disk first; if missing, downloads in background then loads.
+        Loads from memory/disk first, then has the fetcher download a missing
+        icon or revalidate a stale one in the background.
         """
         tid = norm_hex(title_id_8, width=8, lower=True)
         if not tid:
@@ -610,50 +985,57 @@ class IdDatabaseEditor(ttk.Frame):
         # memory
         if tid in self._icon_mem:
             self._apply_icon_photo(tid, self._icon_mem[tid], "Icon: memory cache")
+            self._watch_icon_fetch(tid, cache_dir, shown=True)
             return
 
         # disk
         p = icon_cache_path(cache_dir, tid)
+        force = False
         if os.path.exists(p):
             try:
                 photo = tk.PhotoImage(file=p)
                 self._apply_icon_photo(tid, photo, f"Icon: cached ({os.path.basename(p)})")
+                self._watch_icon_fetch(tid, cache_dir, shown=True)
                 return
             except Exception as e:
                 self._set_icon_status(f"Icon decode failed, re-downloading ({e})")
-                # fall through to download
+                force = True
 
-        # already inflight?
-        if tid in self._icon_fetch_inflight:
-            self._set_icon_status("Icon: downloading…")
-            return
-
-        self._icon_fetch_inflight.add(tid)
         self._clear_icon("")
-
         self._set_icon_status("Icon: downloading…")
+        self._watch_icon_fetch(tid, cache_dir, shown=False, force=force)
 
-        def worker():
-            ok = False
-            try:
-                url = mobcat_icon_url(tid)
-                ok = download_to_file(url, p)
-            finally:
-                def done():
-                    self._icon_fetch_inflight.discard(tid)
-                    if ok and os.path.exists(p):
-                        try:
-                            photo = tk.PhotoImage(file=p)
-                            self._apply_icon_photo(tid, photo, f"Icon: downloaded ({os.path.basename(p)})")
-                        except Exception as e:
-                            self._clear_icon("(icon failed)")
-                            self._set_icon_status(f"Icon decode failed: {e}")
-                    else:
-                        self._clear_icon("(no icon)")
-                        self._set_icon_status("Icon: not found on MobCat")
-                self.master.after(0, done)
+    def _watch_icon_fetch(self, tid: str, cache_dir: str, shown: bool, force: bool = False) -> None:
+        """
+        Requests tid's icon from the fetcher (joining a download already in
+        flight) and updates the preview when it completes, if tid is still
+        the selected title. shown: a cached copy is already displayed.
+        """
+        fut = self._icons.fetch(cache_dir, tid, force=force, selected=True)
 
-        threading.Thread(target=worker, daemon=True).start()
+        def done(result: str):
+            if self._selected_title_id != tid or self._ensure_icon_cache_dir() != cache_dir:
+                if result == ICON_FETCHED:
+                    self._icon_mem.pop(tid, None)
+                return
+            p = icon_cache_path(cache_dir, tid)
+            if result == ICON_FETCHED:
+                try:
+                    photo = tk.PhotoImage(file=p)
+                    self._apply_icon_photo(tid, photo, f"Icon: downloaded ({os.path.basename(p)})")
+                except Exception as e:
+                    self._clear_icon("(icon failed)")
+                    self._set_icon_status(f"Icon decode failed: {e}")
+            elif shown:
+                return
+            elif result == ICON_MISSING:
+                self._clear_icon("(no icon)")
+                self._set_icon_status("Icon: not found on MobCat")
+            else:
+                self._clear_icon("(no icon)")
+                self._set_icon_status("Icon: download failed")
+
+        fut.add_done_callback(lambda f: self.master.after(0, done, f.result()))
 
     def action_set_icon_cache(self):
         start = None
@@ -675,8 +1057,9 @@ class IdDatabaseEditor(ttk.Frame):
 
     def action_prefetch_icons(self):
         """
-        Downloads missing icons for currently loaded database into cache dir.
-        Runs in background; updates status line.
+        Downloads missing icons for currently loaded database into cache dir,
+        and revalidates cached ones not checked for ICON_REVALIDATE_AFTER.
+        Runs on the fetcher's pool; updates status line.
         """
         if not self.model.titles:
             messagebox.showinfo("Prefetch Icons", "No titles loaded.")
@@ -690,7 +1073,7 @@ class IdDatabaseEditor(ttk.Frame):
         # confirm
         if not messagebox.askyesno(
             "Prefetch Missing Icons",
-            f"This will download any missing icons into:\n\n{cache_dir}\n\nContinue?"
+            f"This will download any missing icons, and refresh outdated ones, in:\n\n{cache_dir}\n\nContinue?"
         ):
             return
 
@@ -698,26 +1081,23 @@ class IdDatabaseEditor(ttk.Frame):
         self._set_icon_status("Prefetch: starting…")
 
         def worker():
-            missing = 0
-            fetched = 0
-            for i, tid in enumerate(tids, start=1):
-                p = icon_cache_path(cache_dir, tid)
-                if os.path.exists(p):
-                    continue
-                missing += 1
-                url = mobcat_icon_url(tid)
-                ok = download_to_file(url, p)
-                if ok:
-                    fetched += 1
+            counts = {r: 0 for r in (ICON_FETCHED, ICON_NOT_MODIFIED, ICON_FRESH, ICON_MISSING, ICON_FAILED)}
+            futures = [self._icons.fetch(cache_dir, tid) for tid in tids]
+            for i, fut in enumerate(as_completed(futures), start=1):
+                counts[fut.result()] += 1
                 # update occasionally
                 if i % 25 == 0 or i == len(tids):
-                    def upd(i=i, total=len(tids), fetched=fetched, missing=missing):
-                        self._set_icon_status(f"Prefetch: {i}/{total} scanned, downloaded {fetched}/{missing} missing")
-                    self.master.after(0, upd)
+                    self.master.after(0, self._set_icon_status,
+                                      f"Prefetch: {i}/{len(tids)} checked, downloaded {counts[ICON_FETCHED]}")
 
             def done():
-                self._set_icon_status(f"Prefetch complete: downloaded {fetched}/{missing} missing")
+                self._set_icon_status(
+                    f"Prefetch complete: downloaded {counts[ICON_FETCHED]}, "
+                    f"{counts[ICON_FRESH] + counts[ICON_NOT_MODIFIED]} up to date, "
+                    f"{counts[ICON_MISSING]} not on MobCat, {counts[ICON_FAILED]} failed"
+                )
                 # refresh current selection icon
+                self._icon_mem.clear()
                 tr = self.current_title()
                 if tr:
                     self._load_icon_for_title(tr.title_id)
@@ -751,7 +1131,6 @@ class IdDatabaseEditor(ttk.Frame):
 
         # clear mem cache when switching databases
         self._icon_mem.clear()
-        self._icon_fetch_inflight.clear()
 
         self.populate_titles(select_first=True)
         self._update_title()
@@ -822,7 +1201,7 @@ class IdDatabaseEditor(ttk.Frame):
             messagebox.showinfo("New Title", "That TitleID already exists.")
             return
         self.model.titles[tid_n] = TitleRecord(title_id=tid_n, title_name=self.var_titlename.get().strip())
-        self.model.mark_dirty()
+        self.model.mark_dirty(tid_n)
         self.populate_titles(select_title_id=tid_n)
         self._update_title()
 
@@ -851,14 +1230,17 @@ class IdDatabaseEditor(ttk.Frame):
             tr.title_id = new_tid
             self._selected_title_id = new_tid
 
-            # icon cache rename (disk)
+            # icon cache rename (disk), with the sidecar so the icon is
+            # revalidated against the ETag it was downloaded with
             cache_dir = self._ensure_icon_cache_dir()
             if cache_dir:
-                oldp = icon_cache_path(cache_dir, old_tid)
-                newp = icon_cache_path(cache_dir, new_tid)
+                moves = [(icon_cache_path(cache_dir, old_tid), icon_cache_path(cache_dir, new_tid)),
+                         (icon_meta_path(cache_dir, old_tid), icon_meta_path(cache_dir, new_tid))]
                 try:
-                    if os.path.exists(oldp) and not os.path.exists(newp):
-                        os.rename(oldp, newp)
+                    if not any(os.path.exists(newp) for _, newp in moves):
+                        for oldp, newp in moves:
+                            if os.path.exists(oldp):
+                                os.rename(oldp, newp)
                 except Exception:
                     pass
 
@@ -867,7 +1249,7 @@ class IdDatabaseEditor(ttk.Frame):
                 self._icon_mem[new_tid] = self._icon_mem.pop(old_tid)
 
         tr.title_name = new_name
-        self.model.mark_dirty()
+        self.model.mark_dirty(old_tid, tr.title_id)
         self.populate_titles(select_title_id=tr.title_id)
         self.populate_buckets()
         self._update_title()
@@ -894,7 +1276,7 @@ class IdDatabaseEditor(ttk.Frame):
             return
         tr.content_ids.append(cand)
         tr.content_ids = sorted(set(tr.content_ids))
-        self.model.mark_dirty()
+        self.model.mark_dirty(tr.title_id)
         self.populate_dlc()
         idx = tr.content_ids.index(cand)
         self.lst_dlc.selection_clear(0, "end")
@@ -908,7 +1290,7 @@ class IdDatabaseEditor(ttk.Frame):
         if not tr:
             return
         tr.title_updates.append("0000000000000000")
-        self.model.mark_dirty()
+        self.model.mark_dirty(tr.title_id)
         self.populate_tu()
         idx = len(tr.title_updates) - 1
         self.lst_tu.selection_clear(0, "end")
@@ -927,7 +1309,7 @@ class IdDatabaseEditor(ttk.Frame):
             n += 1
             sha = (f"{n:040x}")[-40:]
         tr.tu_known[sha] = ""
-        self.model.mark_dirty()
+        self.model.mark_dirty(tr.title_id)
         self.populate_known()
         self.select_known_sha1(sha)
         self._update_title()
@@ -941,11 +1323,12 @@ class IdDatabaseEditor(ttk.Frame):
             if not idxs:
                 return
             cid = tr.content_ids[idxs[0]]
-            if not messagebox.askyesno("Remove DLC", f"Remove DLC ContentID:\n{cid}\n\nAlso removes any Archived name for it."):
+            if not messagebox.askyesno("Remove DLC", f"Remove DLC ContentID:\n{cid}\n\nAlso removes any Archived name and fingerprint for it."):
                 return
             tr.content_ids.pop(idxs[0])
             tr.archived.pop(cid, None)
-            self.model.mark_dirty()
+            tr.fingerprints.pop(cid, None)
+            self.model.mark_dirty(tr.title_id)
             self.populate_dlc()
         elif bucket == "TU":
             idxs = self.lst_tu.curselection()
@@ -955,7 +1338,7 @@ class IdDatabaseEditor(ttk.Frame):
             if not messagebox.askyesno("Remove TU", f"Remove Title Update ID:\n{tuid}?"):
                 return
             tr.title_updates.pop(idxs[0])
-            self.model.mark_dirty()
+            self.model.mark_dirty(tr.title_id)
             self.populate_tu()
         elif bucket == "KNOWN":
             idxs = self.lst_known.curselection()
@@ -965,7 +1348,8 @@ class IdDatabaseEditor(ttk.Frame):
             if not messagebox.askyesno("Remove Known", f"Remove Known mapping for SHA1:\n{sha}?"):
                 return
             tr.tu_known.pop(sha, None)
-            self.model.mark_dirty()
+            tr.tu_sizes.pop(sha, None)
+            self.model.mark_dirty(tr.title_id)
             self.populate_known()
 
         self.clear_details()
@@ -1001,6 +1385,12 @@ class IdDatabaseEditor(ttk.Frame):
                     ):
                         return
 
+                fp_raw = self.var_detail_fingerprint.get().strip()
+                fp = norm_hex(fp_raw, lower=True)
+                if fp_raw and (len(fp) != 40 or fp != fp_raw.lower()):
+                    messagebox.showerror("Invalid Fingerprint", "Fingerprint must be 40 hex characters, or empty if not recorded.")
+                    return
+
                 idxs = self.lst_dlc.curselection()
                 if not idxs:
                     return
@@ -1023,7 +1413,14 @@ class IdDatabaseEditor(ttk.Frame):
                 else:
                     tr.archived.pop(new_id, None)
 
-                self.model.mark_dirty()
+                if old_id != new_id:
+                    tr.fingerprints.pop(old_id, None)
+                if fp:
+                    tr.fingerprints[new_id] = fp
+                else:
+                    tr.fingerprints.pop(new_id, None)
+
+                self.model.mark_dirty(tr.title_id)
                 self.populate_dlc(select_id=new_id)
                 self._update_title()
 
@@ -1044,7 +1441,7 @@ class IdDatabaseEditor(ttk.Frame):
                         cleaned.append(x)
                 tr.title_updates = cleaned
 
-                self.model.mark_dirty()
+                self.model.mark_dirty(tr.title_id)
                 self.populate_tu(select_id=new_id)
                 self._update_title()
 
@@ -1057,6 +1454,10 @@ class IdDatabaseEditor(ttk.Frame):
                 messagebox.showerror("Invalid SHA1", "SHA1 must be 40 hex characters.")
                 return
             val = self.var_known_value.get().strip()
+            size_raw = self.var_known_size.get().strip()
+            if size_raw and (not size_raw.isdigit()):
+                messagebox.showerror("Invalid Size", "Size must be a whole number of bytes, or empty if unknown.")
+                return
 
             idxs = self.lst_known.curselection()
             if not idxs:
@@ -1068,9 +1469,14 @@ class IdDatabaseEditor(ttk.Frame):
                     messagebox.showerror("SHA1 In Use", "That SHA1 key already exists.")
                     return
                 tr.tu_known[sha] = tr.tu_known.pop(old_sha)
+                tr.tu_sizes.pop(old_sha, None)
 
             tr.tu_known[sha] = val
-            self.model.mark_dirty()
+            if size_raw:
+                tr.tu_sizes[sha] = int(size_raw)
+            else:
+                tr.tu_sizes.pop(sha, None)
+            self.model.mark_dirty(tr.title_id)
             self.populate_known(select_sha=sha)
             self._update_title()
             return
@@ -1080,38 +1486,12 @@ class IdDatabaseEditor(ttk.Frame):
     # ---------------------------
 
     def action_validate(self):
-        issues = []
-
-        for tid, tr in self.model.titles.items():
-            if len(tid) != 8 or not is_hex(tid):
-                issues.append(f"{tid}: TitleID invalid")
-
-            for cid in tr.content_ids:
-                if len(cid) != 16 or not is_hex(cid):
-                    issues.append(f"{tid} '{tr.title_name}': ContentID invalid: {cid}")
-                if not cid.startswith(tid):
-                    issues.append(f"{tid} '{tr.title_name}': ContentID does not start with TitleID: {cid}")
-
-            for cid in tr.archived.keys():
-                if len(cid) != 16 or not is_hex(cid):
-                    issues.append(f"{tid} '{tr.title_name}': Archived ContentID invalid: {cid}")
-                if cid not in tr.content_ids:
-                    issues.append(f"{tid} '{tr.title_name}': Archived entry not in Content IDs: {cid}")
-
-            for tu in tr.title_updates:
-                if len(tu) != 16 or not is_hex(tu):
-                    issues.append(f"{tid} '{tr.title_name}': TU invalid: {tu}")
-
-            for sha1, val in tr.tu_known.items():
-                if len(sha1) != 40 or not is_hex(sha1):
-                    issues.append(f"{tid} '{tr.title_name}': Known SHA1 invalid: {sha1}")
-                if val is None:
-                    issues.append(f"{tid} '{tr.title_name}': Known SHA1 has empty value: {sha1}")
+        issues, checked = self.model.validate()
 
         if issues:
-            messagebox.showwarning("Validation", "Issues found:\n\n" + "\n".join(issues[:80]) + ("\n… (more)" if len(issues) > 80 else ""))
+            messagebox.showwarning("Validation", f"Issues found ({checked} edited titles re-checked):\n\n" + "\n".join(issues[:80]) + ("\n… (more)" if len(issues) > 80 else ""))
         else:
-            messagebox.showinfo("Validation", "Looks good!")
+            messagebox.showinfo("Validation", f"Looks good! ({checked} edited titles re-checked)")
 
     def action_compute_sha1_global(self):
         path = filedialog.askopenfilename(title="Pick file to hash (SHA1)")
@@ -1134,10 +1514,45 @@ class IdDatabaseEditor(ttk.Frame):
         try:
             digest = self.compute_sha1(path)
             self.var_known_sha1.set(digest)
+            self.var_known_size.set(str(os.path.getsize(path)))
             messagebox.showinfo("SHA1", f"SHA1 = {digest}\n\nNow set the Value and click Apply Changes.")
         except Exception as e:
             messagebox.showerror("SHA1 Error", f"Failed to hash file:\n{e}")
 
+    def action_compute_fingerprint(self):
+        tab = self._current_tab_name()
+        if tab != "DLC":
+            messagebox.showinfo("Fingerprint", "Switch to the 'DLC' tab to use this button.")
+            return
+        path = filedialog.askdirectory(title="Pick DLC content folder (the one named after the ContentID)")
+        if not path:
+            return
+        try:
+            digest = self.compute_fingerprint(path)
+            self.var_detail_fingerprint.set(digest)
+            messagebox.showinfo("Fingerprint", f"Fingerprint = {digest}\n\nClick Apply Changes to record it.")
+        except Exception as e:
+            messagebox.showerror("Fingerprint Error", f"Failed to fingerprint folder:\n{e}")
+
+    @classmethod
+    def compute_fingerprint(cls, path: str) -> str:
+        """
+        Same value as pinecone -fingerprint (see fingerprint.go): SHA1 over one
+        "f <sha1> <name>" or "d <fingerprint> <name>" line per entry, sorted
+        by lowercased name.
+        """
+        lines = []
+        for name in os.listdir(path):
+            full = os.path.join(path, name)
+            if os.path.isdir(full):
+                lines.append((name.lower(), f"d {cls.compute_fingerprint(full)} {name.lower()}\n"))
+            else:
+                lines.append((name.lower(), f"f {cls.compute_sha1(full)} {name.lower()}\n"))
+        h = hashlib.sha1()
+        for _, line in sorted(lines):
+            h.update(line.encode("utf-8"))
+        return h.hexdigest()
+
     @staticmethod
     def compute_sha1(path: str) -> str:
         h = hashlib.sha1()
@@ -1153,16 +1568,10 @@ class IdDatabaseEditor(ttk.Frame):
     def populate_titles(self, select_first: bool = False, select_title_id: Optional[str] = None):
         self.titles_list.delete(0, "end")
 
-        q = (self.search_var.get() or "").lower().strip()
-
-        visible: List[Tuple[str, str]] = []
-        for tid in sorted(self.model.titles.keys()):
-            tr = self.model.titles[tid]
-            disp = f"{tr.title_name} ({tid})" if tr.title_name else tid
-            if not q or q in disp.lower() or q in tid.lower():
-                visible.append((tid, disp))
-                self.titles_list.insert("end", disp)
+        q = self.search_var.get() or ""
 
+        self._visible_ids = self.model.search.query(q)
+        visible: List[Tuple[str, str]] = [(tid, self.model.search.display(tid)) for tid in self._visible_ids]
         if not visible:
             self._selected_title_id = None
             self.clear_title_fields()
@@ -1170,6 +1579,7 @@ class IdDatabaseEditor(ttk.Frame):
             self._clear_icon("(no title)")
             self._set_icon_status("Idle")
             return
+        self.titles_list.insert("end", *(disp for _, disp in visible))
 
         if select_title_id:
             idx = next((i for i, (tid, _) in enumerate(visible) if tid == select_title_id), 0)
@@ -1300,12 +1710,14 @@ class IdDatabaseEditor(ttk.Frame):
             self.ent_detail_id.configure(state="normal")
             self.ent_detail_name.configure(state="normal")
             self.chk_archived.configure(state="normal" if mode == "DLC" else "disabled")
+            self.ent_detail_fingerprint.configure(state="normal" if mode == "DLC" else "disabled")
             self.ent_known_sha1.configure(state="disabled")
             self.ent_known_value.configure(state="disabled")
         else:
             self.ent_detail_id.configure(state="disabled")
             self.ent_detail_name.configure(state="disabled")
             self.chk_archived.configure(state="disabled")
+            self.ent_detail_fingerprint.configure(state="disabled")
             self.ent_known_sha1.configure(state="normal")
             self.ent_known_value.configure(state="normal")
 
@@ -1322,8 +1734,10 @@ class IdDatabaseEditor(ttk.Frame):
             self.var_detail_id.set(cid)
             self.var_detail_name.set(tr.archived.get(cid, ""))
             self.var_detail_archived.set(cid in tr.archived)
+            self.var_detail_fingerprint.set(tr.fingerprints.get(cid, ""))
             self.var_known_sha1.set("")
             self.var_known_value.set("")
+            self.var_known_size.set("")
 
         elif bucket == "TU":
             idxs = self.lst_tu.curselection()
@@ -1333,8 +1747,10 @@ class IdDatabaseEditor(ttk.Frame):
             self.var_detail_id.set(tuid)
             self.var_detail_name.set("")
             self.var_detail_archived.set(False)
+            self.var_detail_fingerprint.set("")
             self.var_known_sha1.set("")
             self.var_known_value.set("")
+            self.var_known_size.set("")
 
         elif bucket == "KNOWN":
             vis = self._known_visible_list(tr)
@@ -1344,9 +1760,11 @@ class IdDatabaseEditor(ttk.Frame):
             sha, val = vis[idxs[0]]
             self.var_known_sha1.set(sha)
             self.var_known_value.set(val)
+            self.var_known_size.set(str(tr.tu_sizes[sha]) if sha in tr.tu_sizes else "")
             self.var_detail_id.set("")
             self.var_detail_name.set("")
             self.var_detail_archived.set(False)
+            self.var_detail_fingerprint.set("")
 
     # ---------------------------
     # Helpers
@@ -1357,18 +1775,10 @@ class IdDatabaseEditor(ttk.Frame):
         if not idxs:
             return None
 
-        q = (self.search_var.get() or "").lower().strip()
-        visible: List[str] = []
-        for tid in sorted(self.model.titles.keys()):
-            tr = self.model.titles[tid]
-            disp = f"{tr.title_name} ({tid})" if tr.title_name else tid
-            if not q or q in disp.lower() or q in tid.lower():
-                visible.append(tid)
-
         i = idxs[0]
-        if i < 0 or i >= len(visible):
+        if i < 0 or i >= len(self._visible_ids):
             return None
-        return self.model.titles.get(visible[i])
+        return self.model.titles.get(self._visible_ids[i])
 
     def clear_title_fields(self):
         self.var_titleid.set("")
@@ -1378,8 +1788,10 @@ class IdDatabaseEditor(ttk.Frame):
         self.var_detail_id.set("")
         self.var_detail_name.set("")
         self.var_detail_archived.set(False)
+        self.var_detail_fingerprint.set("")
         self.var_known_sha1.set("")
         self.var_known_value.set("")
+        self.var_known_size.set("")
 
 
 # ---------------------------
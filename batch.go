@@ -0,0 +1,205 @@
+package main
+
+import (
+	"bufio"
+	"context"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"time"
+
+	fatihColor "github.com/fatih/color"
+)
+
+// reportSink writes scan results to a plain text report.
+type reportSink struct {
+	w io.Writer
+}
+
+func (s reportSink) emit(r *titleResult) {
+	for _, line := range r.lines {
+		fmt.Fprintln(s.w, formatLine(line))
+	}
+}
+
+type batchResult struct {
+	root   string
+	report string
+	stats  scanStats
+	err    error
+}
+
+// loadBatchRoots combines the comma separated -batch list with the roots in
+// the -manifest file (one per line, blank lines and # comments ignored).
+func loadBatchRoots(list string, manifest string) ([]string, error) {
+	var roots []string
+	for _, root := range strings.Split(list, ",") {
+		if root = strings.TrimSpace(root); root != "" {
+			roots = append(roots, root)
+		}
+	}
+
+	if manifest != "" {
+		file, err := os.Open(manifest)
+		if err != nil {
+			return nil, fmt.Errorf("error opening manifest: %v", err)
+		}
+		defer file.Close()
+
+		scanner := bufio.NewScanner(file)
+		for scanner.Scan() {
+			line := strings.TrimSpace(scanner.Text())
+			if line == "" || strings.HasPrefix(line, "#") {
+				continue
+			}
+			roots = append(roots, line)
+		}
+		if err := scanner.Err(); err != nil {
+			return nil, fmt.Errorf("error reading manifest: %v", err)
+		}
+	}
+
+	if len(roots) == 0 {
+		return nil, fmt.Errorf("no dump roots given for batch mode")
+	}
+	return roots, nil
+}
+
+func batchReportName(index int, root string) string {
+	name := strings.Map(func(r rune) rune {
+		if r >= 'a' && r <= 'z' || r >= 'A' && r <= 'Z' || r >= '0' && r <= '9' || r == '-' || r == '.' {
+			return r
+		}
+		return '_'
+	}, filepath.Base(filepath.Clean(root)))
+	return fmt.Sprintf("%03d-%s", index+1, name)
+}
+
+// scanDump opens the dump at root (a directory, archive or drive image) and
+// scans the roots selected with -roots.
+func scanDump(ctx context.Context, root string, sink scanSink) (scanStats, error) {
+	src, err := openDump(root)
+	if err != nil {
+		return scanStats{}, err
+	}
+	defer src.Close()
+
+	roots, err := src.scanRoots()
+	if err != nil {
+		return scanStats{}, err
+	}
+	return checkForContent(ctx, src, roots, sink, nil)
+}
+
+func scanBatchRoot(ctx context.Context, root string, reportPath string) (scanStats, error) {
+	file, err := os.Create(reportPath)
+	if err != nil {
+		return scanStats{}, err
+	}
+	defer file.Close()
+
+	w := bufio.NewWriter(file)
+	sink, _ := newReportSink(w)
+	rec := newScanRecorder(root)
+	if _, isText := sink.(reportSink); isText {
+		fmt.Fprintf(w, "Pinecone v%s\n", version)
+		fmt.Fprintf(w, "Dump: %s\n", root)
+	}
+	stats, scanErr := scanDump(ctx, root, recordingSink{sink, rec})
+	if scanErr == nil {
+		scanErr = rec.save(resultsPathFor(reportPath))
+	}
+	if _, isText := sink.(reportSink); isText && scanErr != nil {
+		fmt.Fprintf(w, "ERROR: %v\n", scanErr)
+	}
+	if err := w.Flush(); err != nil && scanErr == nil {
+		scanErr = err
+	}
+	return stats, scanErr
+}
+
+// runBatch scans every root with the already loaded database, at most
+// batchJobs roots at a time, writing one report and results file per root
+// and an aggregate summary to a timestamped folder in data/output.
+func runBatch(ctx context.Context, roots []string) error {
+	start := time.Now()
+	outputDir := filepath.Join(dataPath, "output", "batch-"+time.Now().Format("2006-01-02-15-04-05"))
+	if err := os.MkdirAll(outputDir, 0o755); err != nil {
+		return fmt.Errorf("error creating batch output folder: %v", err)
+	}
+
+	jobs := batchJobs
+	if jobs < 1 {
+		jobs = 1
+	}
+	slots := make(chan struct{}, jobs)
+	_, reportExt := newReportSink(io.Discard)
+	results := make([]batchResult, len(roots))
+
+	var wg sync.WaitGroup
+	var printMu sync.Mutex
+	finished := 0
+	for i, root := range roots {
+		wg.Add(1)
+		go func(i int, root string) {
+			defer wg.Done()
+			slots <- struct{}{}
+			defer func() { <-slots }()
+
+			res := batchResult{root: root, report: filepath.Join(outputDir, batchReportName(i, root)+reportExt)}
+			res.stats, res.err = scanBatchRoot(ctx, root, res.report)
+			results[i] = res
+
+			printMu.Lock()
+			finished++
+			if res.err != nil {
+				printInfo(fatihColor.FgRed, "[%d/%d] %s: %v\n", finished, len(roots), root, res.err)
+			} else {
+				printInfo(fatihColor.FgGreen, "[%d/%d] %s: %d title directories -> %s\n", finished, len(roots), root, res.stats.TitleDirs, res.report)
+			}
+			printMu.Unlock()
+		}(i, root)
+	}
+	wg.Wait()
+
+	summaryPath := filepath.Join(outputDir, "summary.txt")
+	file, err := os.Create(summaryPath)
+	if err != nil {
+		return fmt.Errorf("error writing batch summary: %v", err)
+	}
+	defer file.Close()
+
+	w := bufio.NewWriter(file)
+	reportSink{io.MultiWriter(w, statusOut)}.emit(batchSummary(results, time.Since(start)))
+	if err := w.Flush(); err != nil {
+		return fmt.Errorf("error writing batch summary: %v", err)
+	}
+	fmt.Printf("Batch summary saved to: %s\n", summaryPath)
+	return nil
+}
+
+func batchSummary(results []batchResult, elapsed time.Duration) *titleResult {
+	total := scanStats{Elapsed: elapsed}
+	failed := 0
+
+	r := &titleResult{}
+	r.addHeader("Batch Summary")
+	for _, res := range results {
+		if res.err != nil {
+			failed++
+			r.addInfo(levelError, "%s: %v", res.root, res.err)
+			continue
+		}
+		r.addInfo(levelInfo, "%s: %d title directories (%s)", res.root, res.stats.TitleDirs, filepath.Base(res.report))
+
+		total.add(res.stats)
+	}
+
+	r.addSeparator()
+	r.addInfo(levelInfo, "Dumps scanned: %d (%d failed)", len(results), failed)
+	r.lines = append(r.lines, total.summary(!noHashCache).lines[1:]...)
+	return r
+}
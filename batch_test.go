@@ -0,0 +1,48 @@
+package main
+
+import (
+	"reflect"
+	"testing"
+	"time"
+)
+
+// TestScanStatsAdd checks that the batch total sums every counter, so a new
+// field of scanStats cannot be left out of it.
+func TestScanStatsAdd(t *testing.T) {
+	var one scanStats
+	v := reflect.ValueOf(&one).Elem()
+	for i := 0; i < v.NumField(); i++ {
+		switch f := v.Field(i); f.Kind() {
+		case reflect.Int, reflect.Int64:
+			f.SetInt(1)
+		case reflect.Array:
+			for j := 0; j < f.Len(); j++ {
+				f.Index(j).SetInt(1)
+			}
+		}
+	}
+
+	total := scanStats{Elapsed: time.Second}
+	total.add(one)
+	total.add(one)
+	got := reflect.ValueOf(total)
+	for i := 0; i < got.NumField(); i++ {
+		name := got.Type().Field(i).Name
+		switch f := got.Field(i); {
+		case name == "Elapsed":
+			if total.Elapsed != time.Second {
+				t.Errorf("Elapsed = %v, want the batch's own", total.Elapsed)
+			}
+		case f.Kind() == reflect.Int || f.Kind() == reflect.Int64:
+			if f.Int() != 2 {
+				t.Errorf("%s = %d, want 2", name, f.Int())
+			}
+		case f.Kind() == reflect.Array:
+			for j := 0; j < f.Len(); j++ {
+				if f.Index(j).Int() != 2 {
+					t.Errorf("%s[%d] = %d, want 2", name, j, f.Index(j).Int())
+				}
+			}
+		}
+	}
+}
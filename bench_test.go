@@ -0,0 +1,200 @@
+package main
+
+import (
+	"bytes"
+	"context"
+	"io"
+	"os"
+	"path"
+	"path/filepath"
+	"sort"
+	"sync"
+	"testing"
+)
+
+// The benchmarks time database loading and scanning against a synthetic
+// dump, generated once per run (see synthOptions). "cold" scans hash every
+// file, "warm" scans run against a filled hash cache; the OS page cache is
+// warm in both.
+
+// discardSink drops scan results, so benchmarks time the scan alone.
+type discardSink struct{}
+
+func (discardSink) emit(*titleResult) {}
+
+// benchEnv is the generated dump shared by the scan benchmarks.
+type benchEnv struct {
+	src         *dumpSource
+	roots       []scanRoot
+	titleDirs   []string
+	updateBytes int64
+}
+
+var (
+	sharedBenchEnv     *benchEnv
+	sharedBenchEnvErr  error
+	sharedBenchEnvOnce sync.Once
+)
+
+func openBenchEnv(b *testing.B) *benchEnv {
+	sharedBenchEnvOnce.Do(func() {
+		dir := filepath.Join(testDir, "dump")
+		opts := synthOptions
+		b.Logf("generating %d titles, %d content entries and %d updates of %d bytes per title", opts.Titles, opts.Content, opts.Updates, opts.UpdateSize)
+		if err := generateDump(dir, opts); err != nil {
+			sharedBenchEnvErr = err
+			return
+		}
+		env := &benchEnv{src: dirSource(dir), roots: []scanRoot{{name: "TDATA", dir: "TDATA"}}}
+		env.titleDirs, sharedBenchEnvErr = benchTitleDirs(env.src, "TDATA")
+		env.updateBytes = int64(len(env.titleDirs)) * int64(opts.Updates) * opts.UpdateSize
+		sharedBenchEnv = env
+	})
+	if sharedBenchEnvErr != nil {
+		b.Fatal(sharedBenchEnvErr)
+	}
+	return sharedBenchEnv
+}
+
+// benchTitleDirs lists the title directories of a generated dump.
+func benchTitleDirs(src *dumpSource, tdata string) ([]string, error) {
+	entries, err := os.ReadDir(filepath.Join(src.dir, tdata))
+	if err != nil {
+		return nil, err
+	}
+	var dirs []string
+	for _, entry := range entries {
+		if entry.IsDir() {
+			dirs = append(dirs, path.Join(tdata, entry.Name()))
+		}
+	}
+	sort.Strings(dirs)
+	return dirs, nil
+}
+
+// useHashCache switches the hash cache on or off for one benchmark. An
+// enabled cache starts out empty and lives in the benchmark's temporary
+// folder.
+func useHashCache(b *testing.B, enabled bool) {
+	savedNoCache, savedCache := noHashCache, sharedHashCache
+	b.Cleanup(func() { noHashCache, sharedHashCache = savedNoCache, savedCache })
+	noHashCache = !enabled
+	sharedHashCache = loadHashCache(filepath.Join(b.TempDir(), hashCacheFileName))
+}
+
+func readTestDatabase(b *testing.B) []byte {
+	data, err := os.ReadFile(testJSONPath)
+	if err != nil {
+		b.Fatal(err)
+	}
+	return data
+}
+
+func BenchmarkLoadJSONData(b *testing.B) {
+	b.SetBytes(int64(len(readTestDatabase(b))))
+	for i := 0; i < b.N; i++ {
+		var t TitleList
+		if err := loadJSONData(testJSONPath, "", "", "", &t, false); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkLoadJSONDataNoSnapshot(b *testing.B) {
+	data := readTestDatabase(b)
+	b.SetBytes(int64(len(data)))
+	for i := 0; i < b.N; i++ {
+		var t TitleList
+		if err := decodeTitleList(newCommentStripper(bytes.NewReader(data)), &t); err != nil {
+			b.Fatal(err)
+		}
+		t.buildIndex()
+	}
+}
+
+func BenchmarkStripJSONComments(b *testing.B) {
+	data := readTestDatabase(b)
+	b.SetBytes(int64(len(data)))
+	for i := 0; i < b.N; i++ {
+		if _, err := io.Copy(io.Discard, newCommentStripper(bytes.NewReader(data))); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkCheckForContentCold(b *testing.B) {
+	env := openBenchEnv(b)
+	useHashCache(b, false)
+	b.SetBytes(env.updateBytes)
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := checkForContent(context.Background(), env.src, env.roots, discardSink{}, nil); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkCheckForContentWarm(b *testing.B) {
+	env := openBenchEnv(b)
+	useHashCache(b, true)
+	if _, err := checkForContent(context.Background(), env.src, env.roots, discardSink{}, nil); err != nil {
+		b.Fatal(err)
+	}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := checkForContent(context.Background(), env.src, env.roots, discardSink{}, nil); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkProcessDLCContent(b *testing.B) {
+	env := openBenchEnv(b)
+	useHashCache(b, false)
+	titles := currentTitles()
+	_, scanners := newScanPass(context.Background(), env.src, env.roots)
+	s := scanners[0]
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for _, dir := range env.titleDirs {
+			titleID := path.Base(dir)
+			if err := s.processDLCContent(path.Join(dir, "$c"), titles.Titles[titleID], titleID, &titleResult{}); err != nil {
+				b.Fatal(err)
+			}
+		}
+	}
+}
+
+// processAllUpdates runs the title update pass over every title of env in a
+// fresh scan pass, so files are not taken from the pass-wide hash memo.
+func processAllUpdates(b *testing.B, env *benchEnv) {
+	titles := currentTitles()
+	_, scanners := newScanPass(context.Background(), env.src, env.roots)
+	s := scanners[0]
+	for _, dir := range env.titleDirs {
+		titleID := path.Base(dir)
+		if err := s.processUpdates(path.Join(dir, "$u"), titles.Titles[titleID], titleID, &titleResult{}); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkProcessUpdatesCold(b *testing.B) {
+	env := openBenchEnv(b)
+	useHashCache(b, false)
+	b.SetBytes(env.updateBytes)
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		processAllUpdates(b, env)
+	}
+}
+
+func BenchmarkProcessUpdatesWarm(b *testing.B) {
+	env := openBenchEnv(b)
+	useHashCache(b, true)
+	processAllUpdates(b, env)
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		processAllUpdates(b, env)
+	}
+}
@@ -1,8 +1,11 @@
 package main
 
 import (
+	"context"
 	"fmt"
 	"log"
+	"os"
+	"os/signal"
 	"strings"
 
 	"github.com/fatih/color"
@@ -19,83 +22,91 @@ type CLIOptions struct {
 	JSONUrl      string
 }
 
-func printHeader(title string) {
+func formatHeader(title string) string {
 	title = strings.TrimSpace(title)
 	if len(title) > headerWidth-6 { // -6 to account for spaces and equals signs
 		title = title[:headerWidth-9] + "..."
 	}
 	formattedTitle := "== " + title + " =="
 	padLen := (headerWidth - len(formattedTitle)) / 2
-	color.New(color.FgCyan).Println(strings.Repeat("=", padLen) + formattedTitle + strings.Repeat("=", headerWidth-padLen-len(formattedTitle)))
+	return strings.Repeat("=", padLen) + formattedTitle + strings.Repeat("=", headerWidth-padLen-len(formattedTitle))
+}
+
+func printHeader(title string) {
+	color.New(color.FgCyan).Println(formatHeader(title))
 }
 
 func printInfo(colorCode color.Attribute, format string, args ...interface{}) {
 	color.New(colorCode).Printf("    "+format, args...)
 }
 
+// formatLine renders a scan result line as uncoloured text, as printLine would.
+func formatLine(line outputLine) string {
+	switch {
+	case line.header:
+		return formatHeader(line.text)
+	case line.level == levelSeparator:
+		return line.text
+	default:
+		return "    " + line.text
+	}
+}
+
+// printLine prints a buffered scan result line using the CLI colour scheme.
+func printLine(line outputLine) {
+	switch {
+	case line.header:
+		printHeader(line.text)
+	case line.level == levelSeparator:
+		fmt.Println(line.text)
+	case line.level == levelGood:
+		printInfo(color.FgGreen, "%s\n", line.text)
+	case line.level == levelWarn:
+		printInfo(color.FgYellow, "%s\n", line.text)
+	case line.level == levelError:
+		printInfo(color.FgRed, "%s\n", line.text)
+	default:
+		printInfo(color.FgWhite, "%s\n", line.text)
+	}
+}
+
 // Prints statistics for a specific title or for all titles if batch is true.
 func printStats(titleID string, batch bool) {
 	if batch {
 		printTotalStats()
 	} else {
+		titles := currentTitles()
 		data, ok := titles.Titles[titleID]
 		if !ok {
 			fmt.Printf("No data found for title ID %s\n", titleID)
 			return
 		}
 		fmt.Printf("Statistics for title ID %s:\n", titleID)
-		printTitleStats(&data)
+		printTitleStats(&data, titles.counts(strings.ToLower(titleID)))
 	}
 }
 
 // Prints statistics for TitleData.
-func printTitleStats(data *TitleData) {
+func printTitleStats(data *TitleData, counts titleCounts) {
 	fmt.Println("Title:", data.TitleName)
-	fmt.Println("Total number of Content IDs:", len(data.ContentIDs))
-	fmt.Println("Total number of Title Updates:", len(data.TitleUpdates))
-	fmt.Println("Total number of Known Title Updates:", len(data.TitleUpdatesKnown))
-	fmt.Println("Total number of Archived items:", len(data.Archived))
+	fmt.Println("Total number of Content IDs:", counts.contentIDs)
+	fmt.Println("Total number of Title Updates:", counts.titleUpdates)
+	fmt.Println("Total number of Known Title Updates:", counts.knownUpdates)
+	fmt.Println("Total number of Archived items:", counts.archived)
 	fmt.Println()
 }
 
 func printTotalStats() {
-	totalTitles := len(titles.Titles)
-	totalContentIDs := 0
-	totalTitleUpdates := 0
-	totalKnownTitleUpdates := 0
-	totalArchivedItems := 0
-
-	// Set to store unique hashes of known title updates and archived items
-	knownTitleUpdateHashes := make(map[string]struct{})
-	archivedItemHashes := make(map[string]struct{})
-
-	for _, data := range titles.Titles {
-		totalContentIDs += len(data.ContentIDs)
-		totalTitleUpdates += len(data.TitleUpdates)
-
-		// Count unique known title updates
-		for _, knownUpdate := range data.TitleUpdatesKnown {
-			for hash := range knownUpdate {
-				knownTitleUpdateHashes[hash] = struct{}{}
-			}
-		}
-
-		// Count unique archived items
-		for _, archivedItem := range data.Archived {
-			for hash := range archivedItem {
-				archivedItemHashes[hash] = struct{}{}
-			}
-		}
-	}
-
-	totalKnownTitleUpdates = len(knownTitleUpdateHashes)
-	totalArchivedItems = len(archivedItemHashes)
-
-	fmt.Println("Total Titles:", totalTitles)
-	fmt.Println("Total Content IDs:", totalContentIDs)
-	fmt.Println("Total Title Updates:", totalTitleUpdates)
-	fmt.Println("Total Known Title Updates:", totalKnownTitleUpdates)
-	fmt.Println("Total Archived Items:", totalArchivedItems)
+	titles := currentTitles()
+	// Known title updates and archived items are counted once however many
+	// titles list them
+	counts := titles.counts("")
+
+	fmt.Println("Total Titles:", len(titles.Titles))
+	fmt.Println("Total Content IDs:", counts.contentIDs)
+	fmt.Println("Total Title Updates:", counts.titleUpdates)
+	fmt.Println("Total Known Title Updates:", counts.knownUpdates)
+	fmt.Println("Total Archived Items:", counts.archived)
 }
 
 func cliPromptForDownload(url string) bool {
@@ -108,25 +119,62 @@ func cliPromptForDownload(url string) bool {
 }
 
 func startCLI(options CLIOptions) {
+	// Ctrl+C stops a scan cleanly, with a summary; a second one exits
+	ctx, stopSignals := signal.NotifyContext(context.Background(), os.Interrupt)
+	defer stopSignals()
+	context.AfterFunc(ctx, stopSignals)
+
+	if diffFlag != "" {
+		oldPath, newPath, ok := strings.Cut(diffFlag, ",")
+		if !ok {
+			log.Fatalln("-diff needs two results files: -diff=old.pcscan,new.pcscan")
+		}
+		if err := runDiff(oldPath, newPath); err != nil {
+			log.Fatalln(err)
+		}
+		return
+	}
+
 	err := checkDataFolder(options.DataFolder)
 	if err != nil {
 		log.Fatalln(err)
 	}
 
-	err = checkDatabaseFile(options.JSONFilePath, options.JSONUrl, updateFlag)
+	err = checkDatabaseFile(ctx, options.JSONFilePath, options.JSONUrl, updateFlag)
 	if err != nil {
 		log.Fatalln(err)
 	}
 
+	if serveAddr != "" {
+		fmt.Fprintf(statusOut, "Pinecone v%s\n", version)
+		if err := runServer(ctx, serveAddr, options.JSONFilePath); err != nil {
+			log.Fatalln(err)
+		}
+		return
+	}
+
+	if batchList != "" || batchManifest != "" {
+		roots, err := loadBatchRoots(batchList, batchManifest)
+		if err != nil {
+			log.Fatalln(err)
+		}
+		fmt.Printf("Pinecone v%s\n", version)
+		fmt.Printf("Scanning %d dumps...\n", len(roots))
+		if err := runBatch(ctx, roots); err != nil {
+			log.Fatalln(err)
+		}
+		return
+	}
+
 	err = checkDumpFolder(dumpLocation)
 	if err != nil {
 		log.Fatalln(err)
 	}
 
-	fmt.Printf("Pinecone v%s\n", version)
-	fmt.Println("Please share output of this program with the Pinecone team if you find anything interesting!")
+	fmt.Fprintf(statusOut, "Pinecone v%s\n", version)
+	fmt.Fprintln(statusOut, "Please share output of this program with the Pinecone team if you find anything interesting!")
 
-	err = checkParsingSettings()
+	err = checkParsingSettings(ctx)
 	if err != nil {
 		log.Fatalln(err)
 	}
@@ -0,0 +1,13 @@
+//go:build !linux
+
+package main
+
+import (
+	"errors"
+	"os"
+)
+
+// cloneFile is only implemented on Linux; elsewhere files are copied.
+func cloneFile(dst, src *os.File) error {
+	return errors.ErrUnsupported
+}
@@ -0,0 +1,22 @@
+//go:build !windows
+
+package main
+
+import (
+	"os"
+	"strconv"
+	"syscall"
+)
+
+// deviceID identifies the device holding path, so files on the same disk
+// share one hashing limit.
+func deviceID(path string) string {
+	info, err := os.Stat(path)
+	if err != nil {
+		return path
+	}
+	if st, ok := info.Sys().(*syscall.Stat_t); ok {
+		return strconv.FormatUint(uint64(st.Dev), 10)
+	}
+	return path
+}
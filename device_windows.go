@@ -0,0 +1,15 @@
+package main
+
+import (
+	"path/filepath"
+	"strings"
+)
+
+// deviceID identifies the device holding path, so files on the same disk
+// share one hashing limit.
+func deviceID(path string) string {
+	if abs, err := filepath.Abs(path); err == nil {
+		path = abs
+	}
+	return strings.ToUpper(filepath.VolumeName(path))
+}
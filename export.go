@@ -0,0 +1,263 @@
+package main
+
+import (
+	"context"
+	"crypto/sha1"
+	"encoding/hex"
+	"encoding/json"
+	"fmt"
+	"io"
+	"io/fs"
+	"os"
+	"path"
+	"path/filepath"
+	"sort"
+	"sync"
+)
+
+// contentStore is a content-addressed copy of the content scans flag as
+// unarchived or unknown. Every file is stored once, as objects/ab/abcd...
+// named by its SHA1, however many dumps it turns up on; items/ holds one
+// manifest per distinct content folder or title update mapping it back to
+// files.
+type contentStore struct {
+	dir string
+
+	mu      sync.Mutex
+	present map[string]bool // objects stored or being stored by this run
+}
+
+// storeItem is the manifest of one exported content folder or title update,
+// written the first time it is exported.
+type storeItem struct {
+	Kind      string      `json:"kind"` // "dlc" or "update"
+	TitleID   string      `json:"titleId"`
+	TitleName string      `json:"titleName,omitempty"`
+	ContentID string      `json:"contentId,omitempty"`
+	Source    string      `json:"source"` // where it was first found
+	Files     []storeFile `json:"files"`
+}
+
+type storeFile struct {
+	Path string `json:"path"` // inside the content folder, or the update's file name
+	SHA1 string `json:"sha1"`
+	Size int64  `json:"size"`
+}
+
+var (
+	contentStoresMu sync.Mutex
+	contentStores   = make(map[string]*contentStore)
+)
+
+// openContentStore returns the store in dir, shared by every scan of the
+// run. Its folders are created as objects are added.
+func openContentStore(dir string) *contentStore {
+	contentStoresMu.Lock()
+	defer contentStoresMu.Unlock()
+
+	st, ok := contentStores[dir]
+	if !ok {
+		st = &contentStore{dir: dir, present: make(map[string]bool)}
+		contentStores[dir] = st
+	}
+	return st
+}
+
+func (st *contentStore) objectPath(sum string) string {
+	return filepath.Join(st.dir, "objects", sum[:2], sum)
+}
+
+// put stores name from fsys under sum, unless an object of that size is
+// already there. The copy is hashed before it is added, and stored under the
+// SHA1 of what was actually copied should that differ from sum (the file
+// changed after it was scanned); put returns that SHA1 and whether the file
+// was copied.
+func (st *contentStore) put(fsys fs.FS, name, sum string, size int64) (string, bool, error) {
+	st.mu.Lock()
+	if st.present[sum] {
+		st.mu.Unlock()
+		return sum, false, nil
+	}
+	st.present[sum] = true
+	st.mu.Unlock()
+
+	if info, err := os.Stat(st.objectPath(sum)); err == nil && info.Size() == size {
+		return sum, false, nil
+	}
+	copied, err := st.copyObject(fsys, name, sum)
+	if err != nil || copied != sum {
+		st.mu.Lock()
+		delete(st.present, sum)
+		if err == nil {
+			st.present[copied] = true
+		}
+		st.mu.Unlock()
+	}
+	if err != nil {
+		return "", false, err
+	}
+	return copied, true, nil
+}
+
+// copyObject copies name into the store through a temporary file, so an
+// interrupted copy never leaves a partial object, and returns the SHA1 of
+// the copy, which names the object. Files of plain folders are cloned
+// (reflinked) where the filesystem allows it; otherwise io.Copy between two
+// *os.File uses copy_file_range on Linux, which keeps the data in the
+// kernel. Either way the copy is read back to be hashed.
+func (st *contentStore) copyObject(fsys fs.FS, name, sum string) (string, error) {
+	dir := filepath.Dir(st.objectPath(sum))
+	if err := os.MkdirAll(dir, 0o755); err != nil {
+		return "", err
+	}
+	src, err := fsys.Open(name)
+	if err != nil {
+		return "", err
+	}
+	defer src.Close()
+
+	tmp, err := os.CreateTemp(dir, ".tmp-*")
+	if err != nil {
+		return "", err
+	}
+	if f, ok := src.(*os.File); !ok || cloneFile(tmp, f) != nil {
+		_, err = io.Copy(tmp, src)
+	}
+	var copied []byte
+	if err == nil {
+		if _, err = tmp.Seek(0, io.SeekStart); err == nil {
+			copied, _, err = hashReader(context.Background(), tmp)
+		}
+	}
+	if closeErr := tmp.Close(); err == nil {
+		err = closeErr
+	}
+	actual := hex.EncodeToString(copied)
+	if err == nil && actual != sum {
+		err = os.MkdirAll(filepath.Dir(st.objectPath(actual)), 0o755)
+	}
+	if err == nil {
+		err = os.Rename(tmp.Name(), st.objectPath(actual))
+	}
+	if err != nil {
+		os.Remove(tmp.Name())
+		return "", err
+	}
+	return actual, nil
+}
+
+// addItem writes the manifest of item to name inside items/, unless one is
+// there already. Manifest names include itemDigest, so an identical copy
+// found again maps to the same manifest and a different one to its own.
+func (st *contentStore) addItem(name string, item storeItem) error {
+	itemPath := filepath.Join(st.dir, "items", filepath.FromSlash(name))
+	if _, err := os.Stat(itemPath); err == nil {
+		return nil
+	}
+	data, err := json.MarshalIndent(item, "", "  ")
+	if err != nil {
+		return err
+	}
+	if err := os.MkdirAll(filepath.Dir(itemPath), 0o755); err != nil {
+		return err
+	}
+	tmpPath := itemPath + ".tmp"
+	if err := os.WriteFile(tmpPath, data, 0o644); err != nil {
+		return err
+	}
+	return os.Rename(tmpPath, itemPath)
+}
+
+// exportFile hashes (normally a hash cache hit) and stores one file,
+// counting it in the pass's export stats.
+func (s *scanner) exportFile(name string, info fs.FileInfo, sum string) (storeFile, error) {
+	if sum == "" {
+		var err error
+		if sum, err = s.hashFile(name, info); err != nil {
+			return storeFile{}, err
+		}
+	}
+	sum, added, err := s.export.put(s.src.fsys, name, sum, info.Size())
+	if err != nil {
+		return storeFile{}, err
+	}
+	if added {
+		s.exportedFiles.Add(1)
+		s.exportedBytes.Add(info.Size())
+	} else {
+		s.exportSkipped.Add(1)
+	}
+	return storeFile{Path: path.Base(name), SHA1: sum, Size: info.Size()}, nil
+}
+
+// exportDLC stores every file of the content folder dir.
+func (s *scanner) exportDLC(dir, titleID, titleName, contentID string, r *titleResult) {
+	item := storeItem{Kind: "dlc", TitleID: titleID, TitleName: titleName, ContentID: contentID, Source: s.src.displayPath(dir)}
+	err := fs.WalkDir(s.src.fsys, dir, func(name string, d fs.DirEntry, err error) error {
+		if err != nil || d.IsDir() {
+			return err
+		}
+		info, err := d.Info()
+		if err != nil {
+			return err
+		}
+		file, err := s.exportFile(name, info, "")
+		if err != nil {
+			return err
+		}
+		file.Path = name[len(dir)+1:]
+		item.Files = append(item.Files, file)
+		return nil
+	})
+	if err == nil {
+		err = s.export.addItem(path.Join(titleID, contentID+"-"+itemDigest(item.Files)+".json"), item)
+	}
+	if err != nil {
+		r.addProblem("Error exporting %s: %v", s.src.displayPath(dir), err)
+		return
+	}
+	r.addInfo(levelInfo, "Exported content folder (%d files) to %s", len(item.Files), s.export.dir)
+}
+
+// exportUpdate stores the title update name; sum is empty for updates that
+// were ruled out by size without being hashed.
+func (s *scanner) exportUpdate(name string, info fs.FileInfo, sum, titleID, titleName string, r *titleResult) string {
+	if info == nil {
+		r.addProblem("Error exporting %s: no file info", s.src.displayPath(name))
+		return sum
+	}
+	file, err := s.exportFile(name, info, sum)
+	if err == nil {
+		item := storeItem{Kind: "update", TitleID: titleID, TitleName: titleName, Source: s.src.displayPath(name), Files: []storeFile{file}}
+		err = s.export.addItem(path.Join(titleID, "update-"+file.SHA1+".json"), item)
+	}
+	if err != nil {
+		r.addProblem("Error exporting %s: %v", s.src.displayPath(name), err)
+		return sum
+	}
+	if sum != "" && file.SHA1 != sum {
+		r.addInfo(levelWarn, "%s changed since it was hashed, exported copy has SHA1 %s", s.src.displayPath(name), file.SHA1)
+	}
+	r.addInfo(levelInfo, "Exported to %s", filepath.Join("objects", file.SHA1[:2], file.SHA1))
+	return file.SHA1
+}
+
+// itemDigest identifies what a content folder holds: the first 12 hex digits
+// of the SHA1 of its files' paths and hashes, in path order.
+func itemDigest(files []storeFile) string {
+	lines := make([]string, len(files))
+	for i, file := range files {
+		lines[i] = file.Path + "\x00" + file.SHA1 + "\n"
+	}
+	sort.Strings(lines)
+	h := sha1.New()
+	for _, line := range lines {
+		io.WriteString(h, line)
+	}
+	return hex.EncodeToString(h.Sum(nil))[:12]
+}
+
+// exportSummary is the summary line for -export.
+func (st scanStats) exportSummary() string {
+	return fmt.Sprintf("Exported: %d new files (%.1f MB), %d already in the store", st.ExportedFiles, float64(st.ExportedBytes)/(1<<20), st.ExportSkipped)
+}
@@ -0,0 +1,452 @@
+package main
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"io/fs"
+	"os"
+	"sort"
+	"strings"
+	"sync"
+	"time"
+)
+
+// A read-only FATX reader, so TDATA/UDATA can be scanned straight from a raw
+// drive dump, a partition dump or a block device without extracting them.
+//
+// A FATX partition starts with a 4 KiB superblock, followed by the FAT (16 or
+// 32 bit entries depending on the cluster count, padded to 4 KiB) and then
+// the cluster area. Cluster numbers start at 1. Directories are cluster
+// chains of 64 byte entries.
+
+const (
+	fatxMagic          = "FATX"
+	fatxSuperblockSize = 0x1000
+	fatxSectorSize     = 512
+	fatxDirEntrySize   = 64
+	fatxMaxNameLength  = 42
+	fatxAttrDirectory  = 0x10
+	fatxEntryDeleted   = 0xE5
+	fatxEntryEnd       = 0xFF
+)
+
+// fatxPartitions is the retail drive layout. F, where present, runs to the
+// end of the drive.
+var fatxPartitions = map[string]struct{ offset, size int64 }{
+	"X": {0x00080000, 0x2EE00000},
+	"Y": {0x2EE80000, 0x2EE00000},
+	"Z": {0x5DC80000, 0x2EE00000},
+	"C": {0x8CA80000, 0x1F400000},
+	"E": {0xABE80000, 0x1312D6000},
+	"F": {0x1DD156000, 0},
+}
+
+type fatxEntry struct {
+	name    string
+	attr    byte
+	cluster uint32
+	size    int64
+	modTime time.Time
+}
+
+func (e fatxEntry) isDir() bool {
+	return e.attr&fatxAttrDirectory != 0
+}
+
+// fatxVolume is one FATX partition. It implements fs.FS, fs.ReadDirFS and
+// fs.StatFS, and is safe for concurrent use.
+type fatxVolume struct {
+	r           io.ReaderAt
+	closer      io.Closer
+	partition   string // partition letter, empty for partition images
+	clusterSize int64
+	clusters    uint32
+	rootCluster uint32
+	fat         []byte
+	fatEntry    int
+	dataOffset  int64
+
+	mu   sync.Mutex
+	dirs map[uint32][]fatxEntry
+}
+
+// openFATXImage opens a raw image or block device. If it starts with a FATX
+// superblock it is read as a single partition, otherwise partition selects
+// one of the retail drive partitions.
+func openFATXImage(path string, partition string) (*fatxVolume, error) {
+	file, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	// Stat reports no size for block devices, seeking does
+	size, err := file.Seek(0, io.SeekEnd)
+	if err != nil {
+		file.Close()
+		return nil, err
+	}
+
+	volume, err := newFATXVolume(file, size, partition)
+	if err != nil {
+		file.Close()
+		return nil, err
+	}
+	volume.closer = file
+	return volume, nil
+}
+
+func newFATXVolume(r io.ReaderAt, imageSize int64, partition string) (*fatxVolume, error) {
+	offset, size := int64(0), imageSize
+	var magic [4]byte
+	if _, err := r.ReadAt(magic[:], 0); err != nil || string(magic[:]) != fatxMagic {
+		partition = strings.ToUpper(partition)
+		layout, ok := fatxPartitions[partition]
+		if !ok {
+			return nil, fmt.Errorf("unknown FATX partition %q", partition)
+		}
+		offset, size = layout.offset, layout.size
+		if size == 0 || offset+size > imageSize {
+			size = imageSize - offset
+		}
+	} else {
+		partition = ""
+	}
+	if size <= fatxSuperblockSize {
+		return nil, fmt.Errorf("image too small for FATX partition %s", partition)
+	}
+
+	superblock := make([]byte, 16)
+	if _, err := r.ReadAt(superblock, offset); err != nil {
+		return nil, err
+	}
+	if string(superblock[:4]) != fatxMagic {
+		return nil, fmt.Errorf("no FATX partition %s found", partition)
+	}
+	sectorsPerCluster := binary.LittleEndian.Uint32(superblock[8:])
+	if sectorsPerCluster == 0 || sectorsPerCluster > 1024 {
+		return nil, fmt.Errorf("invalid FATX cluster size (%d sectors)", sectorsPerCluster)
+	}
+
+	v := &fatxVolume{
+		r:           r,
+		partition:   partition,
+		clusterSize: int64(sectorsPerCluster) * fatxSectorSize,
+		rootCluster: binary.LittleEndian.Uint32(superblock[12:]),
+		dirs:        make(map[uint32][]fatxEntry),
+	}
+	v.clusters = uint32(size / v.clusterSize)
+	v.fatEntry = 4
+	if v.clusters < 0xFFF0 {
+		v.fatEntry = 2
+	}
+	fatSize := int64(v.clusters) * int64(v.fatEntry)
+	fatSize = (fatSize + fatxSuperblockSize - 1) / fatxSuperblockSize * fatxSuperblockSize
+
+	v.fat = make([]byte, fatSize)
+	if _, err := r.ReadAt(v.fat, offset+fatxSuperblockSize); err != nil {
+		return nil, fmt.Errorf("reading FATX allocation table: %v", err)
+	}
+	v.dataOffset = offset + fatxSuperblockSize + fatSize
+	return v, nil
+}
+
+func (v *fatxVolume) Close() error {
+	if v.closer != nil {
+		return v.closer.Close()
+	}
+	return nil
+}
+
+var errFATXCorrupt = errors.New("corrupt FATX cluster chain")
+
+// chain returns the clusters of the chain starting at first.
+func (v *fatxVolume) chain(first uint32) ([]uint32, error) {
+	var chain []uint32
+	for cluster := first; ; {
+		if cluster == 0 || cluster >= v.clusters || len(chain) >= int(v.clusters) {
+			return nil, errFATXCorrupt
+		}
+		chain = append(chain, cluster)
+
+		var next uint32
+		if v.fatEntry == 2 {
+			next = uint32(binary.LittleEndian.Uint16(v.fat[cluster*2:]))
+			if next >= 0xFFF0 {
+				return chain, nil
+			}
+		} else {
+			next = binary.LittleEndian.Uint32(v.fat[cluster*4:])
+			if next >= 0xFFFFFFF0 {
+				return chain, nil
+			}
+		}
+		cluster = next
+	}
+}
+
+func (v *fatxVolume) clusterOffset(cluster uint32) int64 {
+	return v.dataOffset + int64(cluster-1)*v.clusterSize
+}
+
+func fatxTime(t uint32) time.Time {
+	return time.Date(
+		int(t>>25&0x7F)+2000, time.Month(t>>21&0x0F), int(t>>16&0x1F),
+		int(t>>11&0x1F), int(t>>5&0x3F), int(t&0x1F)*2, 0, time.UTC)
+}
+
+// readDir returns the entries of the directory starting at cluster.
+func (v *fatxVolume) readDir(cluster uint32) ([]fatxEntry, error) {
+	v.mu.Lock()
+	entries, ok := v.dirs[cluster]
+	v.mu.Unlock()
+	if ok {
+		return entries, nil
+	}
+
+	chain, err := v.chain(cluster)
+	if err != nil {
+		return nil, err
+	}
+
+	buf := make([]byte, v.clusterSize)
+	entries = []fatxEntry{}
+read:
+	for _, c := range chain {
+		if _, err := v.r.ReadAt(buf, v.clusterOffset(c)); err != nil {
+			return nil, err
+		}
+		for off := 0; off+fatxDirEntrySize <= len(buf); off += fatxDirEntrySize {
+			raw := buf[off : off+fatxDirEntrySize]
+			nameLength := raw[0]
+			if nameLength == 0 || nameLength == fatxEntryEnd {
+				break read
+			}
+			if nameLength == fatxEntryDeleted || nameLength > fatxMaxNameLength {
+				continue
+			}
+			entries = append(entries, fatxEntry{
+				name:    string(raw[2 : 2+nameLength]),
+				attr:    raw[1],
+				cluster: binary.LittleEndian.Uint32(raw[0x2C:]),
+				size:    int64(binary.LittleEndian.Uint32(raw[0x30:])),
+				modTime: fatxTime(binary.LittleEndian.Uint32(raw[0x34:])),
+			})
+		}
+	}
+	sort.Slice(entries, func(i, j int) bool { return entries[i].name < entries[j].name })
+
+	v.mu.Lock()
+	v.dirs[cluster] = entries
+	v.mu.Unlock()
+	return entries, nil
+}
+
+// lookup resolves a slash separated path. FATX names are case-insensitive.
+func (v *fatxVolume) lookup(op string, name string) (fatxEntry, error) {
+	if !fs.ValidPath(name) {
+		return fatxEntry{}, &fs.PathError{Op: op, Path: name, Err: fs.ErrInvalid}
+	}
+
+	entry := fatxEntry{name: ".", attr: fatxAttrDirectory, cluster: v.rootCluster}
+	if name == "." {
+		return entry, nil
+	}
+	for _, part := range strings.Split(name, "/") {
+		if !entry.isDir() {
+			return fatxEntry{}, &fs.PathError{Op: op, Path: name, Err: fs.ErrNotExist}
+		}
+		entries, err := v.readDir(entry.cluster)
+		if err != nil {
+			return fatxEntry{}, &fs.PathError{Op: op, Path: name, Err: err}
+		}
+		found := false
+		for _, e := range entries {
+			if strings.EqualFold(e.name, part) {
+				entry, found = e, true
+				break
+			}
+		}
+		if !found {
+			return fatxEntry{}, &fs.PathError{Op: op, Path: name, Err: fs.ErrNotExist}
+		}
+	}
+	return entry, nil
+}
+
+func (v *fatxVolume) Open(name string) (fs.File, error) {
+	entry, err := v.lookup("open", name)
+	if err != nil {
+		return nil, err
+	}
+	if entry.isDir() {
+		return &fatxDir{volume: v, entry: entry}, nil
+	}
+
+	var chain []uint32
+	if entry.size > 0 {
+		if chain, err = v.chain(entry.cluster); err != nil {
+			return nil, &fs.PathError{Op: "open", Path: name, Err: err}
+		}
+		if int64(len(chain))*v.clusterSize < entry.size {
+			return nil, &fs.PathError{Op: "open", Path: name, Err: errFATXCorrupt}
+		}
+	}
+	return &fatxFile{volume: v, entry: entry, chain: chain}, nil
+}
+
+func (v *fatxVolume) ReadDir(name string) ([]fs.DirEntry, error) {
+	entry, err := v.lookup("readdir", name)
+	if err != nil {
+		return nil, err
+	}
+	if !entry.isDir() {
+		return nil, &fs.PathError{Op: "readdir", Path: name, Err: errors.New("not a directory")}
+	}
+	entries, err := v.readDir(entry.cluster)
+	if err != nil {
+		return nil, &fs.PathError{Op: "readdir", Path: name, Err: err}
+	}
+	list := make([]fs.DirEntry, len(entries))
+	for i, e := range entries {
+		list[i] = fatxInfo{e}
+	}
+	return list, nil
+}
+
+func (v *fatxVolume) Stat(name string) (fs.FileInfo, error) {
+	entry, err := v.lookup("stat", name)
+	if err != nil {
+		return nil, err
+	}
+	return fatxInfo{entry}, nil
+}
+
+// fatxInfo is both the fs.FileInfo and the fs.DirEntry of an entry.
+type fatxInfo struct {
+	entry fatxEntry
+}
+
+func (i fatxInfo) Name() string               { return i.entry.name }
+func (i fatxInfo) Size() int64                { return i.entry.size }
+func (i fatxInfo) ModTime() time.Time         { return i.entry.modTime }
+func (i fatxInfo) IsDir() bool                { return i.entry.isDir() }
+func (i fatxInfo) Sys() interface{}           { return nil }
+func (i fatxInfo) Type() fs.FileMode          { return i.Mode().Type() }
+func (i fatxInfo) Info() (fs.FileInfo, error) { return i, nil }
+
+func (i fatxInfo) Mode() fs.FileMode {
+	if i.entry.isDir() {
+		return fs.ModeDir | 0o555
+	}
+	return 0o444
+}
+
+// fatxFile reads a file's cluster chain directly from the image, merging runs
+// of consecutive clusters into a single read.
+type fatxFile struct {
+	volume *fatxVolume
+	entry  fatxEntry
+	chain  []uint32
+	offset int64
+}
+
+func (f *fatxFile) Stat() (fs.FileInfo, error) { return fatxInfo{f.entry}, nil }
+func (f *fatxFile) Close() error               { return nil }
+
+func (f *fatxFile) Read(p []byte) (int, error) {
+	n, err := f.ReadAt(p, f.offset)
+	f.offset += int64(n)
+	return n, err
+}
+
+func (f *fatxFile) ReadAt(p []byte, off int64) (int, error) {
+	if off < 0 {
+		return 0, &fs.PathError{Op: "read", Path: f.entry.name, Err: fs.ErrInvalid}
+	}
+
+	v := f.volume
+	n := 0
+	for n < len(p) && off < f.entry.size {
+		index := int(off / v.clusterSize)
+		within := off % v.clusterSize
+
+		run := 1
+		for index+run < len(f.chain) && f.chain[index+run] == f.chain[index+run-1]+1 {
+			run++
+		}
+		chunk := int64(run)*v.clusterSize - within
+		if remaining := f.entry.size - off; chunk > remaining {
+			chunk = remaining
+		}
+		if wanted := int64(len(p) - n); chunk > wanted {
+			chunk = wanted
+		}
+
+		read, err := v.r.ReadAt(p[n:n+int(chunk)], v.clusterOffset(f.chain[index])+within)
+		n += read
+		off += int64(read)
+		if err != nil {
+			return n, err
+		}
+	}
+	if n < len(p) {
+		return n, io.EOF
+	}
+	return n, nil
+}
+
+func (f *fatxFile) Seek(offset int64, whence int) (int64, error) {
+	switch whence {
+	case io.SeekStart:
+	case io.SeekCurrent:
+		offset += f.offset
+	case io.SeekEnd:
+		offset += f.entry.size
+	default:
+		return 0, fs.ErrInvalid
+	}
+	if offset < 0 {
+		return 0, fs.ErrInvalid
+	}
+	f.offset = offset
+	return offset, nil
+}
+
+type fatxDir struct {
+	volume  *fatxVolume
+	entry   fatxEntry
+	entries []fatxEntry
+	read    bool
+}
+
+func (d *fatxDir) Stat() (fs.FileInfo, error) { return fatxInfo{d.entry}, nil }
+func (d *fatxDir) Close() error               { return nil }
+
+func (d *fatxDir) Read([]byte) (int, error) {
+	return 0, &fs.PathError{Op: "read", Path: d.entry.name, Err: errors.New("is a directory")}
+}
+
+func (d *fatxDir) ReadDir(count int) ([]fs.DirEntry, error) {
+	if !d.read {
+		entries, err := d.volume.readDir(d.entry.cluster)
+		if err != nil {
+			return nil, err
+		}
+		d.entries, d.read = entries, true
+	}
+
+	n := len(d.entries)
+	if count > 0 && count < n {
+		n = count
+	}
+	if count > 0 && n == 0 {
+		return nil, io.EOF
+	}
+	list := make([]fs.DirEntry, n)
+	for i := range list {
+		list[i] = fatxInfo{d.entries[i]}
+	}
+	d.entries = d.entries[n:]
+	return list, nil
+}
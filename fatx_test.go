@@ -0,0 +1,251 @@
+package main
+
+import (
+	"bytes"
+	"encoding/binary"
+	"errors"
+	"io"
+	"io/fs"
+	"testing"
+	"testing/fstest"
+	"time"
+)
+
+// testFATXTime is the modification time of every entry of the test images.
+var testFATXTime = time.Date(2004, time.November, 9, 13, 45, 30, 0, time.UTC)
+
+// fatxImage builds the start of a FATX partition: the superblock, the FAT
+// and the first few clusters. The rest of the partition reads as zeros.
+type fatxImage struct {
+	data        []byte
+	size        int64 // of the whole partition
+	clusterSize int
+	clusters    uint32
+	fatEntry    int
+	dataOffset  int
+}
+
+func newFATXImage(size int64, clusterSize int) *fatxImage {
+	img := &fatxImage{size: size, clusterSize: clusterSize, clusters: uint32(size / int64(clusterSize)), fatEntry: 4}
+	if img.clusters < 0xFFF0 {
+		img.fatEntry = 2
+	}
+	fatSize := (int(img.clusters)*img.fatEntry + fatxSuperblockSize - 1) / fatxSuperblockSize * fatxSuperblockSize
+	img.dataOffset = fatxSuperblockSize + fatSize
+	img.data = make([]byte, img.dataOffset+9*clusterSize)
+	copy(img.data, fatxMagic)
+	binary.LittleEndian.PutUint32(img.data[8:], uint32(clusterSize/fatxSectorSize))
+	binary.LittleEndian.PutUint32(img.data[12:], 1)
+	return img
+}
+
+// fatxChainEnd ends a cluster chain in FATs of either width.
+const fatxChainEnd = 0xFFFFFFFF
+
+func (img *fatxImage) link(cluster, next uint32) {
+	fat := img.data[fatxSuperblockSize:]
+	if img.fatEntry == 2 {
+		binary.LittleEndian.PutUint16(fat[2*cluster:], uint16(next))
+	} else {
+		binary.LittleEndian.PutUint32(fat[4*cluster:], next)
+	}
+}
+
+func (img *fatxImage) cluster(c uint32) []byte {
+	off := img.dataOffset + (int(c)-1)*img.clusterSize
+	return img.data[off : off+img.clusterSize]
+}
+
+// entry writes directory entry i of the directory in cluster dir.
+func (img *fatxImage) entry(dir uint32, i int, name string, attr byte, first uint32, size int) {
+	raw := img.cluster(dir)[i*fatxDirEntrySize:]
+	raw[0] = byte(len(name))
+	raw[1] = attr
+	copy(raw[2:], name)
+	binary.LittleEndian.PutUint32(raw[0x2C:], first)
+	binary.LittleEndian.PutUint32(raw[0x30:], uint32(size))
+	t := testFATXTime
+	stamp := uint32(t.Year()-2000)<<25 | uint32(t.Month())<<21 | uint32(t.Day())<<16 | uint32(t.Hour())<<11 | uint32(t.Minute())<<5 | uint32(t.Second()/2)
+	binary.LittleEndian.PutUint32(raw[0x34:], stamp)
+}
+
+// file returns the content of default.xbe, which the test images spread
+// over clusters 5, 6 and 8 so reads cross both a contiguous run and a gap.
+func (img *fatxImage) file() []byte {
+	b := make([]byte, 2*img.clusterSize+300)
+	for i := range b {
+		b[i] = byte(i * 7)
+	}
+	return b
+}
+
+// newTestFATXImage lays out TDATA/4d530004/$u with default.xbe, an empty
+// file and a deleted entry.
+func newTestFATXImage(size int64, clusterSize int) *fatxImage {
+	img := newFATXImage(size, clusterSize)
+	for c := uint32(1); c <= 4; c++ {
+		img.link(c, fatxChainEnd)
+	}
+	img.entry(1, 0, "TDATA", fatxAttrDirectory, 2, 0)
+	img.entry(2, 0, "4d530004", fatxAttrDirectory, 3, 0)
+	img.entry(2, 1, "removed", fatxAttrDirectory, 7, 0)
+	img.cluster(2)[fatxDirEntrySize] = fatxEntryDeleted
+	img.entry(3, 0, "$u", fatxAttrDirectory, 4, 0)
+	file := img.file()
+	img.entry(4, 0, "default.xbe", 0, 5, len(file))
+	img.entry(4, 1, "empty.xbe", 0, 0, 0)
+	img.cluster(4)[2*fatxDirEntrySize] = fatxEntryEnd
+
+	img.link(5, 6)
+	img.link(6, 8)
+	img.link(8, fatxChainEnd)
+	copy(img.cluster(5), file)
+	copy(img.cluster(6), file[clusterSize:])
+	copy(img.cluster(8), file[2*clusterSize:])
+	return img
+}
+
+// driveImage is a sparse image holding the start of one partition at
+// offset and zeros everywhere else.
+type driveImage struct {
+	partition []byte
+	offset    int64
+}
+
+func (d driveImage) ReadAt(p []byte, off int64) (int, error) {
+	clear(p)
+	if start := off - d.offset; start < int64(len(d.partition)) && start+int64(len(p)) > 0 {
+		src, dst := d.partition, p
+		if start >= 0 {
+			src = src[start:]
+		} else {
+			dst = dst[-start:]
+		}
+		copy(dst, src)
+	}
+	return len(p), nil
+}
+
+func (img *fatxImage) volume(t *testing.T) *fatxVolume {
+	t.Helper()
+	v, err := newFATXVolume(driveImage{partition: img.data}, img.size, "")
+	if err != nil {
+		t.Fatal(err)
+	}
+	return v
+}
+
+func TestFATXVolume(t *testing.T) {
+	for _, layout := range []struct {
+		name        string
+		size        int64
+		clusterSize int
+	}{
+		{"FAT16", 256 << 10, 512},
+		{"FAT32", 0x10000 * 512, 512},
+	} {
+		t.Run(layout.name, func(t *testing.T) {
+			img := newTestFATXImage(layout.size, layout.clusterSize)
+			v := img.volume(t)
+			if v.fatEntry != img.fatEntry {
+				t.Fatalf("read a %d byte FAT, want %d", v.fatEntry, img.fatEntry)
+			}
+			if err := fstest.TestFS(v, "TDATA/4d530004/$u/default.xbe", "TDATA/4d530004/$u/empty.xbe"); err != nil {
+				t.Fatal(err)
+			}
+
+			data, err := fs.ReadFile(v, "tdata/4D530004/$U/DEFAULT.XBE")
+			if err != nil {
+				t.Fatal(err)
+			}
+			if !bytes.Equal(data, img.file()) {
+				t.Errorf("default.xbe read back differently")
+			}
+
+			entries, err := fs.ReadDir(v, "TDATA")
+			if err != nil {
+				t.Fatal(err)
+			}
+			if len(entries) != 1 || entries[0].Name() != "4d530004" {
+				t.Errorf("TDATA lists %v, want only 4d530004", entries)
+			}
+			info, err := fs.Stat(v, "TDATA/4d530004/$u/default.xbe")
+			if err != nil {
+				t.Fatal(err)
+			}
+			if !info.ModTime().Equal(testFATXTime) || info.Size() != int64(len(data)) {
+				t.Errorf("default.xbe: size %d, modified %v", info.Size(), info.ModTime())
+			}
+			if _, err := fs.Stat(v, "TDATA/removed"); !errors.Is(err, fs.ErrNotExist) {
+				t.Errorf("deleted entry: err = %v", err)
+			}
+		})
+	}
+}
+
+func TestFATXCorruptChain(t *testing.T) {
+	const size, clusterSize = 256 << 10, 512
+
+	loop := newTestFATXImage(size, clusterSize)
+	loop.link(6, 5)
+	if _, err := loop.volume(t).Open("TDATA/4d530004/$u/default.xbe"); !errors.Is(err, errFATXCorrupt) {
+		t.Errorf("cluster loop: err = %v", err)
+	}
+
+	short := newTestFATXImage(size, clusterSize)
+	short.link(6, fatxChainEnd)
+	if _, err := short.volume(t).Open("TDATA/4d530004/$u/default.xbe"); !errors.Is(err, errFATXCorrupt) {
+		t.Errorf("chain shorter than the file: err = %v", err)
+	}
+
+	outside := newTestFATXImage(size, clusterSize)
+	outside.entry(1, 0, "TDATA", fatxAttrDirectory, outside.clusters, 0)
+	if _, err := fs.ReadDir(outside.volume(t), "TDATA"); !errors.Is(err, errFATXCorrupt) {
+		t.Errorf("directory outside the partition: err = %v", err)
+	}
+
+	zero := newTestFATXImage(size, clusterSize)
+	binary.LittleEndian.PutUint32(zero.data[8:], 0)
+	if _, err := newFATXVolume(driveImage{partition: zero.data}, zero.size, ""); err == nil {
+		t.Errorf("opened a partition with no sectors per cluster")
+	}
+}
+
+// TestFATXDrivePartitions reads a retail drive image, whose first
+// partition starts after an unformatted area.
+func TestFATXDrivePartitions(t *testing.T) {
+	x := fatxPartitions["X"]
+	img := newTestFATXImage(x.size, 16<<10)
+	drive := driveImage{partition: img.data, offset: x.offset}
+	size := fatxPartitions["E"].offset
+
+	if _, err := newFATXVolume(drive, size, "Y"); err == nil {
+		t.Errorf("opened partition Y, which holds no FATX superblock")
+	}
+	if _, err := newFATXVolume(drive, size, "Q"); err == nil {
+		t.Errorf("opened unknown partition Q")
+	}
+	if _, err := newFATXVolume(drive, size, "F"); err == nil {
+		t.Errorf("opened partition F past the end of the image")
+	}
+
+	v, err := newFATXVolume(drive, size, "x")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if v.partition != "X" {
+		t.Errorf("partition = %q, want X", v.partition)
+	}
+	f, err := v.Open("TDATA/4d530004/$u/default.xbe")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer f.Close()
+	data, err := io.ReadAll(f)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(data, img.file()) {
+		t.Errorf("default.xbe read back differently")
+	}
+}
@@ -1,32 +1,313 @@
 package main
 
 import (
-	"crypto/sha1"
+	"context"
 	"encoding/json"
+	"errors"
 	"fmt"
-	"image/color"
-	"io"
+	"io/fs"
 	"os"
+	"path"
 	"path/filepath"
 	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// outputLevel selects how a result line is coloured by the CLI and GUI printers.
+type outputLevel int
 
-	"fyne.io/fyne/v2/theme"
-	fatihColor "github.com/fatih/color"
+const (
+	levelInfo outputLevel = iota
+	levelGood
+	levelWarn
+	levelError
+	levelSeparator
 )
 
-func getSHA1Hash(filePath string) (string, error) {
-	file, err := os.Open(filePath)
-	if err != nil {
-		return "", err
+// findingStatus classifies a single piece of content reported by a scan.
+type findingStatus int
+
+const (
+	statusArchived findingStatus = iota
+	statusUnarchived
+	statusUnknown
+	statusMisfiled
+	statusUnrecognizedDir
+	statusModified // known content whose fingerprint differs from the database's
+	numFindingStatuses
+)
+
+var findingStatusNames = [numFindingStatuses]string{
+	"known-archived",
+	"known-unarchived",
+	"unknown",
+	"misfiled",
+	"unrecognized-dir",
+	"modified",
+}
+
+func (st findingStatus) MarshalText() ([]byte, error) {
+	return []byte(findingStatusNames[st]), nil
+}
+
+func (st *findingStatus) UnmarshalText(text []byte) error {
+	for status, name := range findingStatusNames {
+		if name == string(text) {
+			*st = findingStatus(status)
+			return nil
+		}
+	}
+	return fmt.Errorf("unknown finding status %q", text)
+}
+
+// finding is the machine-readable record of one piece of content reported by
+// a scan. Paths are relative to the scanned directory and use forward slashes.
+type finding struct {
+	Kind        string        `json:"kind"` // "dlc", "update" or "xbe"
+	Status      findingStatus `json:"status"`
+	Root        string        `json:"root,omitempty"` // set when several roots are scanned
+	TitleID     string        `json:"titleId"`
+	TitleName   string        `json:"titleName,omitempty"`
+	ContentID   string        `json:"contentId,omitempty"`
+	SHA1        string        `json:"sha1,omitempty"`
+	Name        string        `json:"name,omitempty"`
+	Size        int64         `json:"size,omitempty"`        // set for title updates that were not hashed
+	Fingerprint string        `json:"fingerprint,omitempty"` // set for DLC with -fingerprint
+	DisplayName string        `json:"displayName,omitempty"` // from the DLC's contentmeta.xbx
+	XBE         *xbeHeader    `json:"xbe,omitempty"`         // certificate of a title update or XBE
+	Path        string        `json:"path"`
+	ElapsedMs   float64       `json:"elapsedMs"`  // since the scan started
+	DurationMs  float64       `json:"durationMs"` // spent listing or hashing this item
+}
+
+type outputLine struct {
+	header bool
+	level  outputLevel
+	text   string
+}
+
+// titleResult buffers the output for one title directory, so workers can finish
+// in any order while results are still printed in walk order.
+type titleResult struct {
+	lines    []outputLine
+	findings []finding
+	problems []string   // non-fatal errors, also added to lines
+	summary  *scanStats // set on the final result of a scan
+	titleDir bool       // counted as a title directory in the summary
+	err      error
+}
+
+func (r *titleResult) addFinding(f finding) {
+	r.findings = append(r.findings, f)
+}
+
+func (r *titleResult) addProblem(format string, args ...interface{}) {
+	r.addInfo(levelError, format, args...)
+	r.problems = append(r.problems, r.lines[len(r.lines)-1].text)
+}
+
+func (r *titleResult) addHeader(title string) {
+	r.lines = append(r.lines, outputLine{header: true, text: title})
+}
+
+func (r *titleResult) addInfo(level outputLevel, format string, args ...interface{}) {
+	r.lines = append(r.lines, outputLine{level: level, text: fmt.Sprintf(format, args...)})
+}
+
+func (r *titleResult) addSeparator() {
+	r.lines = append(r.lines, outputLine{level: levelSeparator, text: separator})
+}
+
+// flush writes the buffered lines to the console and, when enabled, the GUI.
+func (r *titleResult) flush() {
+	for _, line := range r.lines {
+		if guiEnabled {
+			addLine(line)
+		}
+		printLine(line)
+	}
+}
+
+// scanSink receives the results of a scan, one title directory at a time in
+// walk order, followed by the scan summary.
+type scanSink interface {
+	emit(r *titleResult)
+}
+
+// consoleSink is the interactive sink used by the CLI and GUI.
+type consoleSink struct{}
+
+func (consoleSink) emit(r *titleResult) {
+	r.flush()
+}
+
+// scanStats are the counters reported in the scan summary.
+type scanStats struct {
+	TitleDirs   int
+	XBEFiles    int // files checked in C/E/F/G roots
+	CacheHits   int64
+	CacheMisses int64
+	Duplicates  int64 // files reached again through another root
+	HashedBytes int64 // read by getSHA1Hash, cache hits excluded
+	Unhashed    int   // title updates ruled out by size alone
+	Findings    [numFindingStatuses]int
+	Reused      int // title directories taken from the incremental scan snapshot
+	// -export only
+	ExportedFiles int64
+	ExportedBytes int64
+	ExportSkipped int64 // already in the store
+	Elapsed       time.Duration
+	Profile       *profileStats // set with -profile
+}
+
+// add sums the counters of another scan into st, as for a batch of dumps.
+// Elapsed and Profile stay those of st.
+func (st *scanStats) add(other scanStats) {
+	st.TitleDirs += other.TitleDirs
+	st.XBEFiles += other.XBEFiles
+	st.CacheHits += other.CacheHits
+	st.CacheMisses += other.CacheMisses
+	st.Duplicates += other.Duplicates
+	st.HashedBytes += other.HashedBytes
+	st.Unhashed += other.Unhashed
+	for status, n := range other.Findings {
+		st.Findings[status] += n
 	}
-	defer file.Close()
+	st.Reused += other.Reused
+	st.ExportedFiles += other.ExportedFiles
+	st.ExportedBytes += other.ExportedBytes
+	st.ExportSkipped += other.ExportSkipped
+}
+
+// scanPass holds the state shared by all workers of a single checkForContent
+// run, across every root it covers.
+type scanPass struct {
+	ctx       context.Context
+	src       *dumpSource
+	titles    *TitleList    // the database when the pass started
+	hashSlots chan struct{} // bounds concurrent getSHA1Hash calls on the source's device
+	cache     *hashCache    // nil when the hash cache is disabled
+	rescan    *rescanSnapshot
+	profile   *scanProfile  // nil unless -profile is set
+	export    *contentStore // nil unless -export is set
+	multiRoot bool
+	start     time.Time
+
+	memoMu sync.Mutex
+	memo   map[string]*memoHash // by hash cache key
+
+	cacheHits     atomic.Int64
+	cacheMisses   atomic.Int64
+	hashedBytes   atomic.Int64
+	unhashed      atomic.Int64
+	duplicates    atomic.Int64
+	reused        atomic.Int64
+	exportedFiles atomic.Int64
+	exportedBytes atomic.Int64
+	exportSkipped atomic.Int64
+	expected      atomic.Int64 // title directories and files found by the walk
+	completed     atomic.Int64 // of which done
+	stats         scanStats
+}
+
+// scanner scans one root of a pass.
+type scanner struct {
+	*scanPass
+	root      string // directory being scanned inside src, trimmed from reported paths
+	label     string // root tag for findings, empty for single root scans
+	titleDirs []string
+
+	// Incremental scans only: the results the snapshot holds for this root
+	// and the results of this scan, which replace them.
+	previous  map[string]rescanTitle
+	resultsMu sync.Mutex
+	results   map[string]rescanTitle
+}
 
-	hash := sha1.New()
-	if _, err := io.Copy(hash, file); err != nil {
+// memoHash is the hash of a file within one pass; done is closed once sum
+// and err are set.
+type memoHash struct {
+	done chan struct{}
+	sum  string
+	err  error
+}
+
+type titleJob struct {
+	run    func() *titleResult
+	result chan *titleResult
+}
+
+var errScanStopped = errors.New("scan stopped")
+
+// reportedError is an error checkForContent has already sent to its sink,
+// so callers that write to the same sink need not report it again.
+type reportedError struct{ error }
+
+func (e reportedError) Unwrap() error { return e.error }
+
+// hashFile returns the SHA1 of name. A file this pass already hashed, such
+// as one under both the E root and TDATA, is not read again, nor are files
+// found in the hash cache. The memo is keyed by the file's path in the
+// dump: files with the same name, size and time can still differ. info may
+// be nil if the file could not be stat'ed.
+func (s *scanPass) hashFile(name string, info fs.FileInfo) (string, error) {
+	if info == nil {
+		return s.hashUncached(name, info)
+	}
+
+	key := s.src.cacheKey(name)
+	s.memoMu.Lock()
+	m, seen := s.memo[key]
+	if !seen {
+		m = &memoHash{done: make(chan struct{})}
+		s.memo[key] = m
+	}
+	s.memoMu.Unlock()
+
+	if seen {
+		<-m.done
+		s.duplicates.Add(1)
+		return m.sum, m.err
+	}
+	m.sum, m.err = s.hashUncached(name, info)
+	close(m.done)
+	return m.sum, m.err
+}
+
+// hashUncached returns the SHA1 of name, reading the file only on a hash
+// cache miss.
+func (s *scanPass) hashUncached(name string, info fs.FileInfo) (string, error) {
+	cacheKey := s.src.cacheKey(name)
+	if s.cache != nil && info != nil {
+		if sum, ok := s.cache.lookup(cacheKey, info); ok {
+			s.cacheHits.Add(1)
+			return sum, nil
+		}
+		s.cacheMisses.Add(1)
+	}
+
+	select {
+	case s.hashSlots <- struct{}{}:
+	case <-s.ctx.Done():
+		return "", s.ctx.Err()
+	}
+	started := time.Now()
+	sum, n, err := getSHA1Hash(s.ctx, s.src.fsys, name)
+	if s.profile != nil {
+		s.profile.hashTime.Add(int64(time.Since(started)))
+	}
+	<-s.hashSlots
+	s.hashedBytes.Add(n)
+	if err != nil {
 		return "", err
 	}
 
-	return fmt.Sprintf("%x", hash.Sum(nil)), nil
+	if s.cache != nil && info != nil {
+		s.cache.store(cacheKey, info, sum)
+	}
+	return sum, nil
 }
 
 func loadIgnoreList(filepath string) ([]string, error) {
@@ -54,213 +335,775 @@ func contains(slice []string, val string) bool {
 	return false
 }
 
-func checkForContent(directory string) error {
-	if _, err := os.Stat(directory); os.IsNotExist(err) {
-		printInfo(fatihColor.FgYellow, "%s directory not found\n", directory)
-		return fmt.Errorf("%s directory not found", directory)
+// checkForContent scans the given roots of src in a single pass, sharing
+// workers and hashes between them, and sends the results to sink in order.
+// The scan stops early, still emitting the summary, when ctx is done or the
+// -timeout expires. If progress is not nil it is sent a scanProgress every
+// progressInterval and once more at the end.
+func checkForContent(ctx context.Context, src *dumpSource, roots []scanRoot, sink scanSink, progress chan<- scanProgress) (scanStats, error) {
+	for _, root := range roots {
+		if _, err := fs.Stat(src.fsys, root.dir); errors.Is(err, fs.ErrNotExist) {
+			r := &titleResult{}
+			r.addProblem("%s directory not found", src.displayPath(root.dir))
+			sink.emit(r)
+			return scanStats{}, reportedError{fmt.Errorf("%s directory not found", src.displayPath(root.dir))}
+		}
 	}
 
-	logOutput := func(s string) {
-		if !guiEnabled {
-			printInfo(fatihColor.FgYellow, s+"\n")
-		} else {
-			addText(theme.PrimaryColorNamed(theme.ColorYellow), s)
-		}
+	workers := scanWorkers
+	if workers < 1 {
+		workers = 1
+	}
+	if scanTimeout > 0 {
+		var cancelTimeout context.CancelFunc
+		ctx, cancelTimeout = context.WithTimeout(ctx, scanTimeout)
+		defer cancelTimeout()
 	}
+	// Cancelling ctx also stops the walk and the workers once the results
+	// have been printed
+	ctx, stop := context.WithCancel(ctx)
+	defer stop()
+	pass, scanners := newScanPass(ctx, src, roots)
 
-	err := filepath.Walk(directory, func(path string, info os.FileInfo, err error) error {
-		if err != nil {
-			return err
-		}
+	jobs := make(chan titleJob)
+	// pending carries each job's result channel in walk order; its buffer
+	// bounds how far the walk may run ahead of the printer.
+	pending := make(chan chan *titleResult, workers*2)
+	done := ctx.Done()
 
-		// Check directories that are exactly 8 characters long, potential titleID
-		if info.IsDir() && len(info.Name()) == 8 {
-			titleID := strings.ToLower(info.Name())
-			titleData, ok := titles.Titles[titleID]
-			if ok {
-				// Process known titles as before
-				if guiEnabled {
-					addHeader(titleData.TitleName)
-				}
-				printHeader(titleData.TitleName)
+	reported := make(chan struct{})
+	if progress != nil {
+		go func() {
+			defer close(reported)
+			pass.reportProgress(progress, done)
+		}()
+	} else {
+		close(reported)
+	}
+
+	var wg sync.WaitGroup
+	for i := 0; i < workers; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for job := range jobs {
+				job.result <- job.run()
+				pass.completed.Add(1)
 			}
+		}()
+	}
 
-			// Check and potentially process $c subdirectory
-			subDirDLC := filepath.Join(path, "$c")
-			subInfoDLC, err := os.Stat(subDirDLC)
-			if err == nil && subInfoDLC.IsDir() {
-				if ok { // Process content if titleID is known
-					err = processDLCContent(subDirDLC, titleData, titleID, directory)
-					if err != nil {
-						return err
-					}
-				} else {
-					logOutput(fmt.Sprintf("DLC content found in unrecognized directory: %s\n", subDirDLC))
+	walkErr := make(chan error, 1)
+	go func() {
+		defer close(pending)
+		defer close(jobs)
+		for i, root := range roots {
+			s := scanners[i]
+			if pass.multiRoot {
+				// Tag each root's results with a header of its own
+				header := &titleResult{}
+				header.addHeader(root.name)
+				result := make(chan *titleResult, 1)
+				result <- header
+				select {
+				case pending <- result:
+				case <-done:
+					walkErr <- errScanStopped
+					return
 				}
 			}
+			var err error
+			if root.files {
+				err = s.walkFiles(jobs, pending, done)
+			} else {
+				err = s.walkTitles(jobs, pending, done)
+			}
+			if err != nil {
+				walkErr <- err
+				return
+			}
+		}
+		walkErr <- nil
+	}()
 
-			// Check and potentially process $u subdirectory
-			subDirUpdates := filepath.Join(path, "$u")
-			subInfoUpdates, err := os.Stat(subDirUpdates)
-			if err == nil && subInfoUpdates.IsDir() {
-				if ok { // Process updates if titleID is known
-					err = processUpdates(subDirUpdates, titleData, titleID, directory)
-					if err != nil {
-						return err
-					}
-				} else {
-					if guiEnabled {
-					}
-					logOutput(fmt.Sprintf("Updates found in unrecognized directory: %s\n", subDirUpdates))
-				}
+	var err error
+	for result := range pending {
+		var r *titleResult
+		select {
+		case r = <-result:
+		case <-done:
+		}
+		if r == nil || ctx.Err() != nil {
+			err = ctx.Err()
+			break
+		}
+		sink.emit(r)
+		if r.titleDir {
+			pass.stats.TitleDirs++
+		}
+		for _, f := range r.findings {
+			pass.stats.Findings[f.Status]++
+			if f.Kind == "xbe" {
+				pass.stats.XBEFiles++
 			}
+		}
+		if r.err != nil {
+			err = reportedError{r.err}
+			break
+		}
+	}
+	if err == nil {
+		// The walk may have seen the cancellation first
+		err = ctx.Err()
+	}
+	stop()
+	wg.Wait()
+	<-reported
+
+	if err == nil {
+		if walkErr := <-walkErr; walkErr != errScanStopped {
+			err = walkErr
+		}
+	}
+
+	pass.stats.CacheHits = pass.cacheHits.Load()
+	pass.stats.CacheMisses = pass.cacheMisses.Load()
+	pass.stats.Duplicates = pass.duplicates.Load()
+	pass.stats.HashedBytes = pass.hashedBytes.Load()
+	pass.stats.Unhashed = int(pass.unhashed.Load())
+	pass.stats.Reused = int(pass.reused.Load())
+	pass.stats.ExportedFiles = pass.exportedFiles.Load()
+	pass.stats.ExportedBytes = pass.exportedBytes.Load()
+	pass.stats.ExportSkipped = pass.exportSkipped.Load()
+	pass.stats.Elapsed = time.Since(pass.start)
+	if pass.profile != nil {
+		pass.stats.Profile = pass.profile.snapshot()
+	}
 
-			if !ok {
-				return filepath.SkipDir // Skip further processing in unrecognized directories
+	summary := pass.stats.summary(pass.cache != nil)
+	switch {
+	case errors.Is(err, context.DeadlineExceeded):
+		summary.addInfo(levelWarn, "Scan timed out after %s, results are incomplete", scanTimeout)
+	case errors.Is(err, context.Canceled):
+		summary.addInfo(levelWarn, "Scan cancelled, results are incomplete")
+	}
+	if pass.cache != nil {
+		if saveErr := pass.cache.save(); saveErr != nil {
+			summary.addInfo(levelWarn, "Could not save hash cache: %v", saveErr)
+		}
+	}
+	// An interrupted scan would drop the titles it never reached
+	if pass.rescan != nil && err == nil {
+		for _, s := range scanners {
+			if s.results == nil {
+				continue
+			}
+			if saveErr := pass.rescan.replace(src.cacheKey(s.root), pass.titles, s.results); saveErr != nil {
+				summary.addInfo(levelWarn, "Could not save scan snapshot: %v", saveErr)
+				break
+			}
+		}
+	}
+	sink.emit(summary)
+	if progress != nil {
+		final := pass.progress()
+		final.Finished = true
+		progress <- final
+	}
+
+	return pass.stats, err
+}
+
+// newScanPass sets up a pass over roots of src, with one scanner per root.
+func newScanPass(ctx context.Context, src *dumpSource, roots []scanRoot) (*scanPass, []*scanner) {
+	pass := &scanPass{
+		ctx:       ctx,
+		src:       src,
+		titles:    currentTitles(),
+		hashSlots: hashSlotsFor(src.device),
+		multiRoot: len(roots) > 1,
+		start:     time.Now(),
+		memo:      make(map[string]*memoHash),
+	}
+	if !noHashCache {
+		pass.cache = openHashCache()
+	}
+	if incrementalScan {
+		pass.rescan = openRescanSnapshot()
+	}
+	if exportDir != "" {
+		pass.export = openContentStore(exportDir)
+	}
+	if profileDir != "" {
+		pass.profile = newScanProfile()
+		profiled := *src
+		profiled.fsys = profiledFS{src.fsys, pass.profile}
+		pass.src = &profiled
+	}
+	scanners := make([]*scanner, len(roots))
+	for i, root := range roots {
+		s := &scanner{scanPass: pass, root: root.dir, titleDirs: root.titleDirs}
+		if pass.multiRoot {
+			s.label = root.name
+		}
+		if pass.rescan != nil && !root.files {
+			s.previous = pass.rescan.previous(src.cacheKey(root.dir), pass.titles)
+			s.results = make(map[string]rescanTitle)
+			if root.titleDirs != nil {
+				// Only some directories are scanned, keep what the
+				// snapshot holds for the others
+				for dir, saved := range s.previous {
+					s.results[dir] = saved
+				}
 			}
 		}
+		scanners[i] = s
+	}
+	return pass, scanners
+}
+
+// queue hands job to the workers, reserving its place in the output first.
+// A nil run means the result is already in job.result.
+func queue(job titleJob, jobs chan<- titleJob, pending chan<- chan *titleResult, done <-chan struct{}) error {
+	select {
+	case pending <- job.result:
+	case <-done:
+		return errScanStopped
+	}
+	if job.run == nil {
 		return nil
+	}
+	select {
+	case jobs <- job:
+	case <-done:
+		return errScanStopped
+	}
+	return nil
+}
+
+// walkTitles queues every potential titleID directory of a TDATA or UDATA
+// root. Each directory is listed once and entry types come from the
+// listing; title directories themselves are left to processTitleDir, which
+// lists them again only as far as it needs to. A root limited to some
+// title directories is not walked at all.
+func (s *scanner) walkTitles(jobs chan<- titleJob, pending chan<- chan *titleResult, done <-chan struct{}) error {
+	if s.titleDirs == nil {
+		return s.walkTitleTree(s.root, jobs, pending, done)
+	}
+	s.expected.Add(int64(len(s.titleDirs)))
+	for _, dir := range s.titleDirs {
+		if err := s.queueTitleDir(dir, jobs, pending, done); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func (s *scanner) walkTitleTree(dir string, jobs chan<- titleJob, pending chan<- chan *titleResult, done <-chan struct{}) error {
+	entries, err := fs.ReadDir(s.src.fsys, dir)
+	if err != nil {
+		return err
+	}
+	// Counting a whole listing up front gives the progress estimate the
+	// size of TDATA from the start
+	for _, d := range entries {
+		if d.IsDir() && len(d.Name()) == 8 {
+			s.expected.Add(1)
+		}
+	}
+
+	for _, d := range entries {
+		if !d.IsDir() {
+			continue
+		}
+		name := path.Join(dir, d.Name())
+
+		// Check directories that are exactly 8 characters long, potential titleID
+		if len(d.Name()) != 8 {
+			if err := s.walkTitleTree(name, jobs, pending, done); err != nil {
+				return err
+			}
+			continue
+		}
+
+		if err := s.queueTitleDir(name, jobs, pending, done); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// queueTitleDir queues the title directory dir, or its saved result if the
+// incremental snapshot still holds for it.
+func (s *scanner) queueTitleDir(dir string, jobs chan<- titleJob, pending chan<- chan *titleResult, done <-chan struct{}) error {
+	job := titleJob{result: make(chan *titleResult, 1)}
+	if saved, unchanged := s.unchangedTitleDir(dir); unchanged {
+		s.keepResult(dir, saved)
+		s.reused.Add(1)
+		s.completed.Add(1)
+		r := saved.result(time.Since(s.start))
+		r.titleDir = true
+		job.result <- r
+	} else {
+		job.run = func() *titleResult { return s.scanTitleDir(dir) }
+	}
+	return queue(job, jobs, pending, done)
+}
+
+// walkFiles queues every .xbe of a C, E, F or G root.
+func (s *scanner) walkFiles(jobs chan<- titleJob, pending chan<- chan *titleResult, done <-chan struct{}) error {
+	return fs.WalkDir(s.src.fsys, s.root, func(name string, d fs.DirEntry, err error) error {
+		if err != nil {
+			return err
+		}
+		if d.IsDir() || !strings.EqualFold(path.Ext(name), ".xbe") {
+			return nil
+		}
+		job := titleJob{
+			run:    func() *titleResult { return s.processXBE(name, d) },
+			result: make(chan *titleResult, 1),
+		}
+		s.expected.Add(1)
+		return queue(job, jobs, pending, done)
 	})
+}
+
+// summary reports the scan-wide counters once every title has been printed.
+func (st scanStats) summary(cacheEnabled bool) *titleResult {
+	r := &titleResult{summary: &st}
+	r.addHeader("Scan Summary")
+	r.addInfo(levelInfo, "Title directories scanned: %d", st.TitleDirs)
+	if st.XBEFiles > 0 {
+		r.addInfo(levelInfo, "XBE files checked: %d", st.XBEFiles)
+	}
+	if incrementalScan {
+		r.addInfo(levelInfo, "Unchanged since the last scan: %d", st.Reused)
+	}
+	for status, n := range st.Findings {
+		if n > 0 {
+			r.addInfo(levelInfo, "Findings (%s): %d", findingStatusNames[status], n)
+		}
+	}
+	if cacheEnabled {
+		r.addInfo(levelInfo, "Hash cache: %d hits, %d misses", st.CacheHits, st.CacheMisses)
+	} else {
+		r.addInfo(levelInfo, "Hash cache: disabled")
+	}
+	if st.HashedBytes > 0 {
+		mb := float64(st.HashedBytes) / (1 << 20)
+		r.addInfo(levelInfo, "Hashed: %.1f MB at %.1f MB/s", mb, mb/st.Elapsed.Seconds())
+	}
+	if st.Unhashed > 0 {
+		r.addInfo(levelInfo, "Title updates not hashed (no known update has their size): %d", st.Unhashed)
+	}
+	if st.Duplicates > 0 {
+		r.addInfo(levelInfo, "Duplicate files hashed once: %d", st.Duplicates)
+	}
+	if exportDir != "" {
+		r.addInfo(levelInfo, "%s", st.exportSummary())
+	}
+	r.addInfo(levelInfo, "Scan time: %s", st.Elapsed.Round(time.Millisecond))
+	if st.Profile != nil {
+		st.Profile.addTo(r, st)
+	}
+	return r
+}
+
+// relPath returns name relative to the scanned directory, for findings.
+func (s *scanner) relPath(name string) string {
+	if s.root == "." {
+		return name
+	}
+	return strings.TrimPrefix(name, s.root+"/")
+}
+
+// shortPath returns name relative to the scanned directory, for display.
+func (s *scanner) shortPath(name string) string {
+	return filepath.FromSlash(s.relPath(name))
+}
+
+// newFinding starts a finding for titleID at path, timed from started.
+func (s *scanner) newFinding(kind string, status findingStatus, titleID string, name string, started time.Time) finding {
+	now := time.Now()
+	return finding{
+		Kind:       kind,
+		Status:     status,
+		Root:       s.label,
+		TitleID:    titleID,
+		Path:       s.relPath(name),
+		ElapsedMs:  float64(now.Sub(s.start).Microseconds()) / 1000,
+		DurationMs: float64(now.Sub(started).Microseconds()) / 1000,
+	}
+}
+
+// unchangedTitleDir returns the saved result for dir if the snapshot holds
+// one and the directory has not changed since it was taken.
+func (s *scanner) unchangedTitleDir(dir string) (rescanTitle, bool) {
+	saved, ok := s.previous[dir]
+	if !ok {
+		return rescanTitle{}, false
+	}
+	fingerprint, err := titleFingerprint(s.src.fsys, dir)
+	if err != nil || fingerprint != saved.Fingerprint {
+		return rescanTitle{}, false
+	}
+	return saved, true
+}
+
+func (s *scanner) keepResult(dir string, saved rescanTitle) {
+	s.resultsMu.Lock()
+	s.results[dir] = saved
+	s.resultsMu.Unlock()
+}
+
+// scanTitleDir processes dir and, for incremental scans, records the result
+// for the next scan. The fingerprint is taken first, so changes made while
+// the directory is being processed are picked up next time.
+func (s *scanner) scanTitleDir(dir string) *titleResult {
+	if s.results == nil {
+		return s.processTitleDir(dir)
+	}
+	fingerprint, fingerprintErr := titleFingerprint(s.src.fsys, dir)
+	r := s.processTitleDir(dir)
+	if fingerprintErr == nil && r.err == nil {
+		s.keepResult(dir, newRescanTitle(fingerprint, r))
+	}
+	return r
+}
+
+// titleSubDirs finds the $c and $u subdirectories, in any case, among the
+// entries of the title directory dir. Either is empty if missing.
+func titleSubDirs(dir string, entries []fs.DirEntry) (dlc, updates string) {
+	for _, entry := range entries {
+		switch {
+		case !entry.IsDir():
+		case strings.EqualFold(entry.Name(), "$c"):
+			dlc = path.Join(dir, entry.Name())
+		case strings.EqualFold(entry.Name(), "$u"):
+			updates = path.Join(dir, entry.Name())
+		}
+	}
+	return dlc, updates
+}
+
+// processTitleDir checks the $c and $u subdirectories of a single potential
+// titleID directory and returns everything it found.
+func (s *scanner) processTitleDir(dir string) *titleResult {
+	r := &titleResult{titleDir: true}
+
+	titleID := strings.ToLower(path.Base(dir))
+	titleData, ok := s.titles.Titles[titleID]
+	if ok {
+		r.addHeader(titleData.TitleName)
+	}
+
+	// One listing tells whether $c and $u exist
+	started := time.Now()
+	entries, err := fs.ReadDir(s.src.fsys, dir)
+	if err != nil {
+		r.err = err
+		return r
+	}
+	subDirDLC, subDirUpdates := titleSubDirs(dir, entries)
+
+	// Check and potentially process $c subdirectory
+	if subDirDLC != "" {
+		if ok { // Process content if titleID is known
+			if err := s.processDLCContent(subDirDLC, titleData, titleID, r); err != nil {
+				r.err = err
+				return r
+			}
+		} else {
+			r.addInfo(levelWarn, "DLC content found in unrecognized directory: %s", s.src.displayPath(subDirDLC))
+			r.addFinding(s.newFinding("dlc", statusUnrecognizedDir, titleID, subDirDLC, started))
+		}
+	}
+
+	// Check and potentially process $u subdirectory
+	if subDirUpdates != "" {
+		if ok { // Process updates if titleID is known
+			if err := s.processUpdates(subDirUpdates, titleData, titleID, r); err != nil {
+				r.err = err
+				return r
+			}
+		} else {
+			r.addInfo(levelWarn, "Updates found in unrecognized directory: %s", s.src.displayPath(subDirUpdates))
+			r.addFinding(s.newFinding("update", statusUnrecognizedDir, titleID, subDirUpdates, started))
+		}
+	}
 
-	return err
+	return r
 }
 
-func processDLCContent(subDirDLC string, titleData TitleData, titleID string, directory string) error {
-	subContents, err := os.ReadDir(subDirDLC)
+func (s *scanner) processDLCContent(subDirDLC string, titleData TitleData, titleID string, r *titleResult) error {
+	subContents, err := fs.ReadDir(s.src.fsys, subDirDLC)
 	if err != nil {
 		return err
 	}
 
 	for _, subContent := range subContents {
-		subContentPath := filepath.Join(subDirDLC, subContent.Name())
+		started := time.Now()
+		subContentPath := path.Join(subDirDLC, subContent.Name())
 		if !subContent.IsDir() {
 			continue
 		}
 
-		subDirContents, err := os.ReadDir(subContentPath)
+		subDirContents, err := fs.ReadDir(s.src.fsys, subContentPath)
 		if err != nil {
 			return err
 		}
 
-		hasContentMetaXbx := false
+		var contentMetaXbx string
 		for _, dlcFiles := range subDirContents {
 			if strings.Contains(strings.ToLower(dlcFiles.Name()), "contentmeta.xbx") && !dlcFiles.IsDir() {
-				hasContentMetaXbx = true
+				contentMetaXbx = path.Join(subContentPath, dlcFiles.Name())
 				break
 			}
 		}
 
-		if !hasContentMetaXbx {
+		if contentMetaXbx == "" {
 			continue
 		}
 
 		contentID := strings.ToLower(subContent.Name())
-		if !contains(titleData.ContentIDs, contentID) {
-			if guiEnabled {
-				addText(theme.ErrorColor(), "Unknown content found at: %s", subContentPath)
+		status, archivedName := s.titles.contentStatus(titleID, contentID)
+		var fingerprint string
+		if fingerprintDLC {
+			if fingerprint, err = s.contentFingerprint(subContentPath); err != nil {
+				r.addProblem("Error fingerprinting %s: %v", s.src.displayPath(subContentPath), err)
 			}
-			printInfo(fatihColor.FgRed, "Unknown content found at: %s\n", subContentPath)
-			continue
 		}
-
-		archivedName := ""
-		for _, archived := range titleData.Archived {
-			for archivedID, name := range archived {
-				if archivedID == contentID {
-					archivedName = name
-					break
-				}
+		if status == statusUnknown {
+			r.addInfo(levelError, "Unknown content found at: %s", s.src.displayPath(subContentPath))
+			if fingerprint != "" {
+				r.addInfo(levelError, "Fingerprint: %s", fingerprint)
 			}
-			if archivedName != "" {
-				break
+			displayName := s.readContentMeta(contentMetaXbx, titleID, contentID, r)
+			f := s.newFinding("dlc", statusUnknown, titleID, subContentPath, started)
+			f.TitleName, f.ContentID, f.Fingerprint, f.DisplayName = titleData.TitleName, contentID, fingerprint, displayName
+			r.addFinding(f)
+			if s.export != nil {
+				s.exportDLC(subContentPath, titleID, titleData.TitleName, contentID, r)
 			}
+			continue
 		}
 
-		subContentPath = strings.TrimPrefix(subContentPath, directory+"/")
-		if archivedName != "" {
-			if guiEnabled {
-				addText(theme.PrimaryColorNamed(theme.ColorGreen), "Content is known and archived %s", archivedName)
-			}
-			printInfo(fatihColor.FgGreen, "Content is known and archived %s\n", archivedName)
+		recorded, hasRecorded := s.titles.recordedFingerprint(titleID, contentID)
+		switch {
+		case fingerprint != "" && hasRecorded && fingerprint != recorded:
+			status = statusModified
+			r.addInfo(levelWarn, "%s content at %s differs from the archived copy %s", titleData.TitleName, s.shortPath(subContentPath), archivedName)
+			r.addInfo(levelWarn, "Fingerprint: %s, expected %s", fingerprint, recorded)
+		case status == statusArchived:
+			r.addInfo(levelGood, "Content is known and archived %s", archivedName)
+		default:
+			r.addInfo(levelWarn, "%s has unarchived content found at: %s", titleData.TitleName, s.shortPath(subContentPath))
+		}
+		switch {
+		case fingerprint == "" || status == statusModified:
+		case hasRecorded:
+			r.addInfo(levelGood, "Fingerprint matches the database: %s", fingerprint)
+		default:
+			r.addInfo(levelInfo, "Fingerprint (not in the database): %s", fingerprint)
+		}
+		displayName := s.readContentMeta(contentMetaXbx, titleID, contentID, r)
+		f := s.newFinding("dlc", status, titleID, subContentPath, started)
+		f.TitleName, f.ContentID, f.Name, f.Fingerprint = titleData.TitleName, contentID, archivedName, fingerprint
+		f.DisplayName = displayName
+		r.addFinding(f)
+		if s.export != nil && status == statusUnarchived {
+			s.exportDLC(subContentPath, titleID, titleData.TitleName, contentID, r)
+		}
+	}
 
-		} else {
-			if guiEnabled {
-				addText(theme.ErrorColor(), "%s has unarchived content found at: %s", titleData.TitleName, subContentPath)
-			}
-			printInfo(fatihColor.FgYellow, "%s has unarchived content found at: %s\n", titleData.TitleName, subContentPath)
+	return nil
+}
 
+// readContentMeta reports the header of a content folder's contentmeta.xbx
+// and returns its display name. Files in a format Pinecone does not know
+// are passed over quietly.
+func (s *scanner) readContentMeta(name, titleID, contentID string, r *titleResult) string {
+	meta, err := readContentMeta(s.src.fsys, name)
+	if err != nil {
+		if !errors.Is(err, errNoHeader) {
+			r.addProblem("Error reading %s: %v", s.src.displayPath(name), err)
 		}
+		return ""
+	}
+	if meta.DisplayName != "" {
+		r.addInfo(levelInfo, "Display name: %s", meta.DisplayName)
 	}
+	if meta.TitleID != titleID || meta.OfferID != contentID {
+		r.addInfo(levelWarn, "%s is for content %s of title %s", s.shortPath(name), meta.OfferID, meta.TitleID)
+	}
+	return meta.DisplayName
+}
 
-	return nil
+// readXBEHeader returns the certificate of the XBE name, reporting read
+// errors as problems; nil means there is nothing to show.
+func (s *scanner) readXBEHeader(name string, r *titleResult) *xbeHeader {
+	xbe, err := readXBEHeader(s.src.fsys, name)
+	if err != nil {
+		if !errors.Is(err, errNoHeader) {
+			r.addProblem("Error reading %s: %v", s.src.displayPath(name), err)
+		}
+		return nil
+	}
+	return xbe
+}
+
+// addXBEInfo adds the certificate line of an XBE found for titleID, and a
+// warning if the certificate is for another title.
+func addXBEInfo(r *titleResult, level outputLevel, xbe *xbeHeader, titleID string) {
+	if xbe == nil {
+		return
+	}
+	r.addInfo(level, "XBE: %s", xbe)
+	if titleID != "" && xbe.TitleID != titleID {
+		r.addInfo(levelWarn, "XBE certificate is for title %s, not %s", xbe.TitleID, titleID)
+	}
 }
 
-func processUpdates(subDirUpdates string, titleData TitleData, titleID string, directory string) error {
-	files, err := os.ReadDir(subDirUpdates)
+func (s *scanner) processUpdates(subDirUpdates string, titleData TitleData, titleID string, r *titleResult) error {
+	files, err := fs.ReadDir(s.src.fsys, subDirUpdates)
 	if err != nil {
 		return err
 	}
 
-	knownUpdateFound := false
+	var updates []string
+	var infos []fs.FileInfo
 	for _, f := range files {
-		if filepath.Ext(f.Name()) != ".xbe" {
-			continue
+		if path.Ext(f.Name()) == ".xbe" {
+			info, _ := f.Info()
+			updates = append(updates, f.Name())
+			infos = append(infos, info)
 		}
+	}
 
-		filePath := filepath.Join(subDirUpdates, f.Name())
-		fileHash, err := getSHA1Hash(filePath)
-		if err != nil {
-			if guiEnabled {
-				addText(theme.ErrorColor(), "Error calculating hash for file: %s, error: %s", f.Name(), err.Error())
+	// Read the certificate of and hash every update concurrently, then
+	// report them in directory order. Updates whose size rules out every
+	// known update are not hashed at all, unless -hashunknown asks for
+	// their SHA1.
+	hashes := make([]string, len(updates))
+	hashErrs := make([]error, len(updates))
+	hashTook := make([]time.Duration, len(updates))
+	unhashed := make([]bool, len(updates))
+	headers := make([]*xbeHeader, len(updates))
+	headerErrs := make([]error, len(updates))
+	var wg sync.WaitGroup
+	for i, name := range updates {
+		if !hashUnknown && infos[i] != nil && !s.titles.mayBeKnownUpdate(titleID, infos[i].Size()) {
+			unhashed[i] = true
+			s.unhashed.Add(1)
+		}
+		wg.Add(1)
+		go func(i int, filePath string) {
+			defer wg.Done()
+			headers[i], headerErrs[i] = readXBEHeader(s.src.fsys, filePath)
+			if unhashed[i] {
+				return
 			}
-			printInfo(fatihColor.FgRed, "Error calculating hash for file: %s, error: %s\n", f.Name(), err.Error())
+			started := time.Now()
+			hashes[i], hashErrs[i] = s.hashFile(filePath, infos[i])
+			hashTook[i] = time.Since(started)
+		}(i, path.Join(subDirUpdates, name))
+	}
+	wg.Wait()
 
-			continue
+	for i, name := range updates {
+		if err := headerErrs[i]; err != nil && !errors.Is(err, errNoHeader) {
+			r.addProblem("Error reading %s: %v", s.src.displayPath(path.Join(subDirUpdates, name)), err)
 		}
-
-		for _, knownUpdate := range titleData.TitleUpdatesKnown {
-			for knownHash, name := range knownUpdate {
-				if knownHash == fileHash {
-					if guiEnabled {
-						addHeader("File Info")
-						addText(theme.PrimaryColorNamed(theme.ColorGreen), "Known and Archived Title update found for %s (%s) (%s)", titleData.TitleName, titleID, name)
-						filePath = strings.TrimPrefix(filePath, directory+"/")
-						addText(theme.PrimaryColorNamed(theme.ColorGreen), "Path: %s", filePath)
-						addText(theme.PrimaryColorNamed(theme.ColorGreen), "SHA1: %s", fileHash)
-						addText(color.Transparent, separator)
-					}
-					printHeader("File Info")
-					printInfo(fatihColor.FgGreen, "Known and Archive Title update found for %s (%s) (%s)\n", titleData.TitleName, titleID, name)
-					filePath = strings.TrimPrefix(filePath, directory+"/")
-					printInfo(fatihColor.FgGreen, "Path: %s\n", filePath)
-					printInfo(fatihColor.FgGreen, "SHA1: %s\n", fileHash)
-					fmt.Println(separator)
-
-					knownUpdateFound = true
-					break
-				}
-			}
-			if knownUpdateFound {
-				break
+		if unhashed[i] {
+			fullPath := path.Join(subDirUpdates, name)
+			f := s.newFinding("update", statusUnknown, titleID, fullPath, time.Now())
+			f.TitleName, f.Size, f.XBE = titleData.TitleName, infos[i].Size(), headers[i]
+			f.DurationMs = 0
+			r.addHeader("File Info")
+			r.addInfo(levelError, "Unknown Title Update found for %s (%s)", titleData.TitleName, titleID)
+			r.addInfo(levelError, "Path: %s", s.shortPath(fullPath))
+			r.addInfo(levelError, "Size: %d bytes, no known update has this size (not hashed, use -hashunknown for its SHA1)", f.Size)
+			addXBEInfo(r, levelError, headers[i], titleID)
+			if s.export != nil {
+				f.SHA1 = s.exportUpdate(fullPath, infos[i], "", titleID, titleData.TitleName, r)
 			}
+			r.addFinding(f)
+			continue
+		}
+		if hashErrs[i] != nil {
+			r.addProblem("Error calculating hash for file: %s, error: %s", name, hashErrs[i].Error())
+			continue
 		}
 
-		if !knownUpdateFound {
-			if guiEnabled {
-				addHeader("File Info")
-				addText(theme.ErrorColor(), "Unknown Title Update found for %s (%s)", titleData.TitleName, titleID)
-				filePath = strings.TrimPrefix(filePath, directory+"/")
-				addText(theme.ErrorColor(), "Path: %s", filePath)
-				addText(theme.ErrorColor(), "SHA1: %s", fileHash)
-			}
-			printHeader("File Info")
-			printInfo(fatihColor.FgRed, "Unknown Title Update found for %s (%s)\n", titleData.TitleName, titleID)
-			filePath = strings.TrimPrefix(filePath, directory+"/")
-			printInfo(fatihColor.FgRed, "Path: %s\n", filePath)
-			printInfo(fatihColor.FgRed, "SHA1: %s\n", fileHash)
+		fileHash := hashes[i]
+		fullPath := path.Join(subDirUpdates, name)
+		filePath := s.shortPath(fullPath)
+		f := s.newFinding("update", statusUnknown, titleID, fullPath, time.Now())
+		f.TitleName, f.SHA1, f.XBE = titleData.TitleName, fileHash, headers[i]
+		f.DurationMs = float64(hashTook[i].Microseconds()) / 1000
 
+		status, update := s.titles.updateStatus(titleID, fileHash)
+		switch status {
+		case statusArchived:
+			r.addHeader("File Info")
+			r.addInfo(levelGood, "Known and Archived Title update found for %s (%s) (%s)", titleData.TitleName, titleID, update.name)
+			r.addInfo(levelGood, "Path: %s", filePath)
+			r.addInfo(levelGood, "SHA1: %s", fileHash)
+			addXBEInfo(r, levelGood, headers[i], titleID)
+			r.addSeparator()
+			f.Status, f.Name = statusArchived, update.name
+		case statusMisfiled:
+			r.addHeader("File Info")
+			r.addInfo(levelWarn, "Title update for %s (%s) is filed under %s (%s) (%s)", titleData.TitleName, titleID, s.titles.Titles[update.titleID].TitleName, update.titleID, update.name)
+			r.addInfo(levelWarn, "Path: %s", filePath)
+			r.addInfo(levelWarn, "SHA1: %s", fileHash)
+			addXBEInfo(r, levelWarn, headers[i], titleID)
+			r.addSeparator()
+			f.Status, f.Name = statusMisfiled, update.name
+		default:
+			r.addHeader("File Info")
+			r.addInfo(levelError, "Unknown Title Update found for %s (%s)", titleData.TitleName, titleID)
+			r.addInfo(levelError, "Path: %s", filePath)
+			r.addInfo(levelError, "SHA1: %s", fileHash)
+			addXBEInfo(r, levelError, headers[i], titleID)
+			if s.export != nil {
+				f.SHA1 = s.exportUpdate(fullPath, infos[i], fileHash, titleID, titleData.TitleName, r)
+			}
 		}
+		r.addFinding(f)
 	}
 
 	return nil
 }
+
+// processXBE checks a single .xbe found on a C, E, F or G root against every
+// title update in the database.
+func (s *scanner) processXBE(name string, d fs.DirEntry) *titleResult {
+	r := &titleResult{}
+	started := time.Now()
+	info, _ := d.Info()
+	xbe := s.readXBEHeader(name, r)
+	fileHash, err := s.hashFile(name, info)
+	if err != nil {
+		r.addProblem("Error calculating hash for file: %s, error: %s", s.src.displayPath(name), err.Error())
+		return r
+	}
+
+	f := s.newFinding("xbe", statusUnknown, "", name, started)
+	f.SHA1, f.XBE = fileHash, xbe
+	if status, update := s.titles.updateStatus("", fileHash); status == statusArchived {
+		titleName := s.titles.Titles[update.titleID].TitleName
+		r.addHeader("File Info")
+		r.addInfo(levelGood, "Known Title update for %s (%s) (%s)", titleName, update.titleID, update.name)
+		r.addInfo(levelGood, "Path: %s", s.src.displayPath(name))
+		r.addInfo(levelGood, "SHA1: %s", fileHash)
+		addXBEInfo(r, levelGood, xbe, update.titleID)
+		r.addSeparator()
+		f.Status, f.TitleID, f.TitleName, f.Name = statusArchived, update.titleID, titleName, update.name
+	} else {
+		r.addInfo(levelWarn, "Unknown XBE found at: %s (SHA1: %s)", s.src.displayPath(name), fileHash)
+		addXBEInfo(r, levelWarn, xbe, "")
+	}
+	r.addFinding(f)
+	return r
+}
@@ -0,0 +1,144 @@
+package main
+
+import (
+	"crypto/sha1"
+	"encoding/binary"
+	"encoding/hex"
+	"fmt"
+	"hash"
+	"hash/fnv"
+	"io/fs"
+	"path"
+	"sort"
+	"strings"
+	"sync"
+)
+
+// A content fingerprint identifies what a $c content folder holds rather
+// than what it is called. Every file is hashed with SHA1 and every folder,
+// the content folder included, hashes to the SHA1 of one line per entry,
+// sorted by name:
+//
+//	f <SHA1 of the file> <name>\n
+//	d <hash of the folder> <name>\n
+//
+// Names are lowercased, as FATX ignores case. Fingerprints of archived
+// content are recorded under "Content Fingerprints" in id_database.json;
+// JSONEditor computes the same value from a folder on disk.
+
+// contentNode is a file or folder inside a content folder.
+type contentNode struct {
+	name     string // lowercased
+	path     string
+	dir      bool
+	info     fs.FileInfo    // files only
+	sum      string         // files only, once hashed
+	children []*contentNode // folders only, sorted by name
+}
+
+// hash returns the Merkle hash of a folder whose files have all been hashed.
+func (n *contentNode) hash() string {
+	h := sha1.New()
+	for _, child := range n.children {
+		if child.dir {
+			fmt.Fprintf(h, "d %s %s\n", child.hash(), child.name)
+		} else {
+			fmt.Fprintf(h, "f %s %s\n", child.sum, child.name)
+		}
+	}
+	return hex.EncodeToString(h.Sum(nil))
+}
+
+// contentListing is a content folder as listed, before any file is read.
+// size and stamp summarise every path, size and modification time in it,
+// so an unchanged folder is a single hash cache hit.
+type contentListing struct {
+	root  *contentNode
+	files []*contentNode
+	size  int64
+	stamp int64
+}
+
+func listContent(fsys fs.FS, dir string) (*contentListing, error) {
+	l := &contentListing{root: &contentNode{path: dir, dir: true}}
+	stamp := fnv.New64a()
+	if err := l.list(fsys, l.root, stamp); err != nil {
+		return nil, err
+	}
+	l.stamp = int64(stamp.Sum64())
+	return l, nil
+}
+
+func (l *contentListing) list(fsys fs.FS, n *contentNode, stamp hash.Hash64) error {
+	entries, err := fs.ReadDir(fsys, n.path)
+	if err != nil {
+		return err
+	}
+	var buf [16]byte
+	for _, entry := range entries {
+		child := &contentNode{
+			name: strings.ToLower(entry.Name()),
+			path: path.Join(n.path, entry.Name()),
+			dir:  entry.IsDir(),
+		}
+		stamp.Write([]byte(child.path))
+		if child.dir {
+			stamp.Write([]byte{'/'})
+			if err := l.list(fsys, child, stamp); err != nil {
+				return err
+			}
+		} else {
+			if child.info, err = entry.Info(); err != nil {
+				return err
+			}
+			binary.LittleEndian.PutUint64(buf[:8], uint64(child.info.Size()))
+			binary.LittleEndian.PutUint64(buf[8:], uint64(child.info.ModTime().UnixNano()))
+			stamp.Write(buf[:])
+			l.size += child.info.Size()
+			l.files = append(l.files, child)
+		}
+		n.children = append(n.children, child)
+	}
+	sort.Slice(n.children, func(i, j int) bool { return n.children[i].name < n.children[j].name })
+	return nil
+}
+
+// contentFingerprint returns the fingerprint of the content folder dir. Its
+// files are hashed concurrently, like the updates of a title, and the
+// fingerprint is kept in the hash cache under the folder's own key.
+func (s *scanPass) contentFingerprint(dir string) (string, error) {
+	l, err := listContent(s.src.fsys, dir)
+	if err != nil {
+		return "", err
+	}
+	cacheKey := s.src.cacheKey(dir) + "/"
+	if s.cache != nil {
+		if sum, ok := s.cache.lookupStamp(cacheKey, l.size, l.stamp); ok {
+			s.cacheHits.Add(1)
+			return sum, nil
+		}
+		s.cacheMisses.Add(1)
+	}
+
+	errs := make([]error, len(l.files))
+	var wg sync.WaitGroup
+	for i, file := range l.files {
+		wg.Add(1)
+		go func(i int, file *contentNode) {
+			defer wg.Done()
+			file.sum, errs[i] = s.hashFile(file.path, file.info)
+		}(i, file)
+	}
+	wg.Wait()
+	for _, err := range errs {
+		if err != nil {
+			return "", err
+		}
+	}
+
+	sum := l.root.hash()
+	if s.cache != nil {
+		s.cache.storeStamp(cacheKey, l.size, l.stamp, sum)
+	}
+	return sum, nil
+}
@@ -0,0 +1,105 @@
+package main
+
+import (
+	"bufio"
+	"flag"
+	"fmt"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"sort"
+)
+
+// synthDumpOptions describes a synthetic dump built from the title database.
+type synthDumpOptions struct {
+	Titles     int   // title directories, taken from the database in ID order
+	Content    int   // $c entries per title; the title's own content IDs come first
+	Updates    int   // .xbe files per $u
+	UpdateSize int64 // bytes per .xbe
+}
+
+// synthOptions shapes the dump the benchmarks run against, see the README.
+var synthOptions = synthDumpOptions{Titles: 100, Content: 4, Updates: 2, UpdateSize: 1 << 20}
+
+func init() {
+	flag.IntVar(&synthOptions.Titles, "gentitles", synthOptions.Titles, "Title directories in the synthetic dump")
+	flag.IntVar(&synthOptions.Content, "gencontent", synthOptions.Content, "$c entries per title in the synthetic dump")
+	flag.IntVar(&synthOptions.Updates, "genupdates", synthOptions.Updates, ".xbe files per title in the synthetic dump")
+	flag.Int64Var(&synthOptions.UpdateSize, "genupdatesize", synthOptions.UpdateSize, "Size in bytes of each .xbe in the synthetic dump")
+}
+
+// generateDump writes a synthetic TDATA tree to dir. File contents are
+// pseudo-random but reproducible, so repeated runs produce identical dumps
+// and identical hashes.
+func generateDump(dir string, opts synthDumpOptions) error {
+	titles := currentTitles()
+	ids := make([]string, 0, len(titles.Titles))
+	for id := range titles.Titles {
+		ids = append(ids, id)
+	}
+	sort.Strings(ids)
+	if opts.Titles < len(ids) {
+		ids = ids[:opts.Titles]
+	}
+
+	buf := make([]byte, hashChunkSize)
+	for t, titleID := range ids {
+		titleDir := filepath.Join(dir, "TDATA", titleID)
+
+		for _, sub := range []string{"$c", "$u"} {
+			if err := os.MkdirAll(filepath.Join(titleDir, sub), 0o755); err != nil {
+				return err
+			}
+		}
+
+		contentIDs := titles.contentIDs(titleID)
+		for c := 0; c < opts.Content; c++ {
+			contentID := fmt.Sprintf("%sf%07x", titleID, c)
+			if c < len(contentIDs) {
+				contentID = contentIDs[c]
+			}
+			contentDir := filepath.Join(titleDir, "$c", contentID)
+			if err := os.MkdirAll(contentDir, 0o755); err != nil {
+				return err
+			}
+			meta := []byte("XBX" + contentID)
+			if err := os.WriteFile(filepath.Join(contentDir, "contentmeta.xbx"), meta, 0o644); err != nil {
+				return err
+			}
+		}
+
+		for u := 0; u < opts.Updates; u++ {
+			name := filepath.Join(titleDir, "$u", fmt.Sprintf("update%d.xbe", u))
+			seed := int64(t)<<16 | int64(u)
+			if err := writeSynthFile(name, opts.UpdateSize, rand.New(rand.NewSource(seed)), buf); err != nil {
+				return err
+			}
+		}
+	}
+	return nil
+}
+
+func writeSynthFile(name string, size int64, rng *rand.Rand, buf []byte) error {
+	file, err := os.Create(name)
+	if err != nil {
+		return err
+	}
+	w := bufio.NewWriterSize(file, len(buf))
+	for size > 0 {
+		chunk := buf
+		if int64(len(chunk)) > size {
+			chunk = chunk[:size]
+		}
+		rng.Read(chunk)
+		if _, err := w.Write(chunk); err != nil {
+			file.Close()
+			return err
+		}
+		size -= int64(len(chunk))
+	}
+	if err := w.Flush(); err != nil {
+		file.Close()
+		return err
+	}
+	return file.Close()
+}
@@ -2,6 +2,8 @@
 package main
 
 import (
+	"bufio"
+	"context"
 	"encoding/json"
 	"fmt"
 	"image/color"
@@ -10,6 +12,8 @@ import (
 	"path"
 	"path/filepath"
 	"strings"
+	"sync"
+	"sync/atomic"
 	"time"
 
 	"fyne.io/fyne/v2"
@@ -40,10 +44,7 @@ type Settings struct {
 	Reddit   string `json:"reddit"`
 }
 
-var (
-	outputContainer = container.New(layout.NewVBoxLayout())
-	guiCyan         = color.RGBA{0, 139, 139, 255}
-)
+var guiCyan = color.RGBA{0, 139, 139, 255}
 
 const (
 	guiHeaderWidth = 50
@@ -59,11 +60,28 @@ func addHeader(title string) {
 	addText(theme.ForegroundColor(), strings.Repeat("=", padLen)+formattedTitle+strings.Repeat("=", guiHeaderWidth-padLen-len(formattedTitle)))
 }
 
+// addText queues a line for the GUI output. It is safe to call from any
+// goroutine; see renderOutput.
 func addText(textColor color.Color, format string, args ...interface{}) {
-	output := canvas.NewText(fmt.Sprintf(format, args...), textColor)
-	outputContainer.Add(output)
-	outputContainer.Refresh()
-	outputContainer.Show()
+	guiLogQueue <- guiLogLine{text: fmt.Sprintf(format, args...), color: textColor}
+}
+
+// addLine adds a buffered scan result line using the GUI colour scheme.
+func addLine(line outputLine) {
+	switch {
+	case line.header:
+		addHeader(line.text)
+	case line.level == levelSeparator:
+		addText(color.Transparent, line.text)
+	case line.level == levelGood:
+		addText(theme.PrimaryColorNamed(theme.ColorGreen), "%s", line.text)
+	case line.level == levelWarn:
+		addText(theme.PrimaryColorNamed(theme.ColorYellow), "%s", line.text)
+	case line.level == levelError:
+		addText(theme.ErrorColor(), "%s", line.text)
+	default:
+		addText(theme.ForegroundColor(), "%s", line.text)
+	}
 }
 
 func loadSettings() (*Settings, error) {
@@ -185,62 +203,111 @@ func setDumpFolder(window fyne.Window) {
 
 		if _, err := os.Stat(path.Join(tmpDumpPath + "TDATA")); os.IsNotExist(err) {
 			dumpLocation = tmpDumpPath
-			output := canvas.NewText("Path set to: "+tmpDumpPath, theme.ForegroundColor())
-			outputContainer.Add(output)
+			addText(theme.ForegroundColor(), "Path set to: %s", tmpDumpPath)
 		} else {
-			output := canvas.NewText("Incorrect pathing. Please select a dump with TDATA folder.\n", theme.ForegroundColor())
-			outputContainer.Add(output)
+			addText(theme.ForegroundColor(), "Incorrect pathing. Please select a dump with TDATA folder.")
 		}
 	}, window)
 }
 
-func guiScanDump() {
+func guiScanDump(ctx context.Context) {
 	err := checkDumpFolder(dumpLocation)
 	if nil != err {
 		fmt.Println("ERROR: ", err.Error())
 		addText(theme.ErrorColor(), err.Error())
 	}
 
-	err = checkParsingSettings()
+	err = checkParsingSettings(ctx)
 	if nil != err {
 		fmt.Println("ERROR: ", err.Error())
 		addText(theme.ErrorColor(), err.Error())
 	}
 }
 
+// The scan the GUI is running. Starting a scan cancels the one before it and
+// waits for it to stop, so their output never mixes.
+var (
+	guiScanMu     sync.Mutex
+	guiScanCancel context.CancelFunc
+	guiScanDone   chan struct{}
+
+	guiProgress     *widget.ProgressBar
+	guiProgressText atomic.Pointer[string]
+
+	// The findings of the last complete scan, saved next to the output
+	guiLastScan atomic.Pointer[scanRecorder]
+)
+
+// guiStartScan runs the scan on its own goroutine so the window stays
+// responsive; results reach the output through addText.
 func guiStartScan(options GUIOptions, window fyne.Window) {
-	outputContainer.RemoveAll()
 	if dumpLocation == "" {
-		output := canvas.NewText("Please set a path first.", theme.ForegroundColor())
-		outputContainer.Add(output)
-	} else {
-		output := canvas.NewText("Checking for Content...", theme.ForegroundColor())
-		outputContainer.Add(output)
-		err := checkDatabaseFile(options.JSONFilePath, options.JSONUrl, updateFlag, window)
+		clearOutput()
+		addText(theme.ForegroundColor(), "Please set a path first.")
+		return
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan struct{})
+	guiScanMu.Lock()
+	if guiScanCancel != nil {
+		guiScanCancel()
+	}
+	previous := guiScanDone
+	guiScanCancel, guiScanDone = cancel, done
+	guiScanMu.Unlock()
+
+	go func() {
+		defer close(done)
+		if previous != nil {
+			<-previous
+		}
+		clearOutput()
+		guiShowProgress(scanProgress{})
+		addText(theme.ForegroundColor(), "Checking for Content...")
+		err := checkDatabaseFile(ctx, options.JSONFilePath, options.JSONUrl, updateFlag, window)
 		if err != nil {
 			fmt.Println("ERROR: ", err.Error())
 			addText(theme.ErrorColor(), err.Error())
 		}
+	}()
+}
+
+// guiCancelScan stops the running scan, if any.
+func guiCancelScan() {
+	guiScanMu.Lock()
+	defer guiScanMu.Unlock()
+	if guiScanCancel != nil {
+		guiScanCancel()
 	}
 }
 
-func guiShowDownloadConfirmation(window fyne.Window, filePath string, url string) {
+// guiShowProgress moves the progress bar under the output.
+func guiShowProgress(p scanProgress) {
+	if guiProgress == nil {
+		return
+	}
+	text := p.String()
+	guiProgressText.Store(&text)
+	guiProgress.SetValue(p.fraction())
+}
+
+func guiShowDownloadConfirmation(ctx context.Context, window fyne.Window, filePath string, url string) {
 	message := fmt.Sprintf("The required JSON data is not found.\nIt can be downloaded from:\n%s\nDo you want to download it now?", url)
 	confirmation := dialog.NewConfirm("Confirmation", message, func(confirmed bool) {
 		if confirmed {
-			// Action to perform if confirmed
-			err := loadJSONData(filePath, "Xbox-Preservation-Project", "Pinecone", dataPath+"/id_database.json", &titles, true)
-			if err != nil {
-				text := fmt.Sprintf("error downloading data: %v", err)
-				output := canvas.NewText(text, theme.ErrorColor())
-				outputContainer.Add(output)
-				return
-			}
-			guiScanDump()
+			// Action to perform if confirmed, off the UI thread
+			go func() {
+				err := loadTitleDatabase(filePath, dataPath+"/id_database.json", true)
+				if err != nil {
+					addText(theme.ErrorColor(), "error downloading data: %v", err)
+					return
+				}
+				guiScanDump(ctx)
+			}()
 		} else {
 			// Action to perform if canceled
-			output := canvas.NewText("Download aborted by user", theme.ErrorColor())
-			outputContainer.Add(output)
+			addText(theme.ErrorColor(), "Download aborted by user")
 		}
 	}, window)
 
@@ -263,34 +330,42 @@ func saveOutput(settings *Settings) {
 			panic(err)
 		}
 	}
-	fileText := ""
+	file, err := os.Create(outputPath)
+	if err != nil {
+		panic(err)
+	}
+	defer file.Close()
+	w := bufio.NewWriter(file)
 	// Add user info to top of file
 	if settings.UserName != "" {
-		fileText += fmt.Sprintf("Username: %s\n", settings.UserName)
+		fmt.Fprintf(w, "Username: %s\n", settings.UserName)
 	}
 	if settings.Discord != "" {
-		fileText += fmt.Sprintf("Discord Username: @%s\n", settings.Discord)
+		fmt.Fprintf(w, "Discord Username: @%s\n", settings.Discord)
 	}
 	if settings.Twitter != "" {
-		fileText += fmt.Sprintf("Twitter Username: @%s\n", settings.Twitter)
+		fmt.Fprintf(w, "Twitter Username: @%s\n", settings.Twitter)
 	}
 	if settings.Reddit != "" {
-		fileText += fmt.Sprintf("Reddit Username: u/%s\n", settings.Reddit)
+		fmt.Fprintf(w, "Reddit Username: u/%s\n", settings.Reddit)
 	}
-	// Write output to file
-	for _, obj := range outputContainer.Objects {
-		if textObj, ok := obj.(*canvas.Text); ok {
-			// Append the text value to the string
-			fileText += textObj.Text + "\n"
-		}
+	// Stream the output straight from the log to the file
+	if err := guiLog.writeTo(w); err != nil {
+		panic(err)
 	}
-	err := os.WriteFile(outputPath, []byte(fileText), 0o644)
-	if err != nil {
+	if err := w.Flush(); err != nil {
 		panic(err)
 	}
 	// Debug output, show the path we're scanning
-	output := widget.NewLabel("Output saved to: " + outputPath + "\n")
-	outputContainer.Add(output)
+	addText(theme.ForegroundColor(), "Output saved to: %s", outputPath)
+	if rec := guiLastScan.Load(); rec != nil {
+		resultsFile := resultsPathFor(outputPath)
+		if err := rec.save(resultsFile); err != nil {
+			addText(theme.ErrorColor(), "Error saving scan results: %v", err)
+			return
+		}
+		addText(theme.ForegroundColor(), "Scan results saved to: %s (compare scans with -diff)", resultsFile)
+	}
 }
 
 func loadImage(name, path string) *fyne.StaticResource {
@@ -308,11 +383,9 @@ func startGUI(options GUIOptions) {
 	a := app.New()
 	windowName := fmt.Sprintf("Pinecone %s", version)
 	w := a.NewWindow(windowName)
-	output := widget.NewLabel("")
 
 	// First Load welcome message
-	fakeConsole := fmt.Sprintf("Welcome to Pinecone v%s\n", version)
-	output.SetText(output.Text + fakeConsole)
+	addText(theme.ForegroundColor(), "Welcome to Pinecone v%s", version)
 
 	w.Resize(fyne.Size{Width: 800, Height: 600})
 
@@ -340,11 +413,20 @@ func startGUI(options GUIOptions) {
 	})
 	saveOutput.SetToolTip("Save Output")
 
+	cancelScan := ttwidget.NewButtonWithIcon("", theme.CancelIcon(), guiCancelScan)
+	cancelScan.SetToolTip("Cancel Scan")
+
 	updateJSON := ttwidget.NewButtonWithIcon("", theme.DownloadIcon(), func() {
-		updateJSON := true
-		err := checkDatabaseFile(options.JSONFilePath, options.JSONUrl, updateJSON, nil)
-		if err != nil {
-			fmt.Println(err)
+		// Scans keep running on the old database until the new one is ready
+		started := refreshTitleDatabase(options.JSONFilePath, func(err error) {
+			if err != nil {
+				addText(theme.ErrorColor(), "error updating data: %v", err)
+				return
+			}
+			addText(theme.ForegroundColor(), "Database updated, new scans will use it.")
+		})
+		if !started {
+			addText(theme.ForegroundColor(), "A database update is already running.")
 		}
 	})
 	updateJSON.SetToolTip("Update Database")
@@ -371,17 +453,26 @@ func startGUI(options GUIOptions) {
 	sideMenu := container.NewVBox()
 
 	// Create a container with vertical box layout for the buttons
-	buttons := container.NewVBox(setFolder, scanPath, updateJSON, saveOutput, settingsButton, exit)
+	buttons := container.NewVBox(setFolder, scanPath, cancelScan, updateJSON, saveOutput, settingsButton, exit)
 
 	// Add the hamburger button to the hamburgerMenu
 	sideMenu.Add(buttons)
 
-	outputContainer.Add(output)
-	// Create a container with scroll for the output
-	outputScroll := container.NewScroll(outputContainer)
+	// The output list scrolls itself and only creates widgets for visible lines
+	outputList := newOutputList()
+	go renderOutput(outputList)
+
+	// Scan progress sits under the output
+	guiProgress = widget.NewProgressBar()
+	guiProgress.TextFormatter = func() string {
+		if text := guiProgressText.Load(); text != nil {
+			return *text
+		}
+		return ""
+	}
 
 	// Create a container to hold the main content of the window
-	mainContent := container.NewBorder(nil, nil, nil, nil, outputScroll)
+	mainContent := container.NewBorder(nil, guiProgress, nil, nil, outputList)
 
 	// Create a container that includes the hamburger menu and main content
 	fullContent := container.NewBorder(nil, nil, sideMenu, nil, mainContent)
@@ -0,0 +1,152 @@
+package main
+
+import (
+	"fmt"
+	"image/color"
+	"io"
+	"sync"
+	"time"
+
+	"fyne.io/fyne/v2"
+	"fyne.io/fyne/v2/canvas"
+	"fyne.io/fyne/v2/theme"
+	"fyne.io/fyne/v2/widget"
+)
+
+// The GUI output is a model of coloured lines rendered by a virtualized
+// widget.List. Producers (the scan, button callbacks) never touch widgets:
+// addText queues lines on guiLogQueue, and a single render loop drains the
+// queue and refreshes the list at most once per frame.
+
+const (
+	guiFrameInterval = time.Second / 30
+	guiLogQueueSize  = 4096
+	guiLogCapacity   = 50000 // lines kept before the oldest are dropped
+)
+
+type guiLogLine struct {
+	text  string
+	color color.Color
+	clear bool // clears the log instead of adding a line
+}
+
+// guiLogModel is a ring buffer of at most capacity lines. Appending is O(1);
+// once full, each new line replaces the oldest one.
+type guiLogModel struct {
+	mu       sync.Mutex
+	capacity int
+	lines    []guiLogLine
+	start    int // index of the oldest line once the buffer has wrapped
+	dropped  int // lines discarded since the last clear
+}
+
+var (
+	guiLog      = &guiLogModel{capacity: guiLogCapacity}
+	guiLogQueue = make(chan guiLogLine, guiLogQueueSize)
+)
+
+func (m *guiLogModel) apply(line guiLogLine) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	if line.clear {
+		m.lines = m.lines[:0]
+		m.start = 0
+		m.dropped = 0
+		return
+	}
+	if len(m.lines) < m.capacity {
+		m.lines = append(m.lines, line)
+		return
+	}
+	m.lines[m.start] = line
+	m.start = (m.start + 1) % m.capacity
+	m.dropped++
+}
+
+func (m *guiLogModel) len() int {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	return len(m.lines)
+}
+
+// line returns the i-th line, counting from the oldest one still kept.
+func (m *guiLogModel) line(i int) (guiLogLine, bool) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	if i < 0 || i >= len(m.lines) {
+		return guiLogLine{}, false
+	}
+	return m.lines[(m.start+i)%len(m.lines)], true
+}
+
+// writeTo writes the text of every kept line to w, oldest first.
+func (m *guiLogModel) writeTo(w io.Writer) error {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	if m.dropped > 0 {
+		if _, err := fmt.Fprintf(w, "(%d earlier lines were dropped from the output)\n", m.dropped); err != nil {
+			return err
+		}
+	}
+	for i := range m.lines {
+		if _, err := io.WriteString(w, m.lines[(m.start+i)%len(m.lines)].text+"\n"); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// clearOutput empties the GUI output. It is queued like any other line, so
+// lines added before the call never show up after it.
+func clearOutput() {
+	guiLogQueue <- guiLogLine{clear: true}
+}
+
+func newOutputList() *widget.List {
+	return widget.NewList(
+		guiLog.len,
+		func() fyne.CanvasObject {
+			return canvas.NewText("", theme.ForegroundColor())
+		},
+		func(id widget.ListItemID, item fyne.CanvasObject) {
+			line, ok := guiLog.line(id)
+			if !ok {
+				return
+			}
+			text := item.(*canvas.Text)
+			text.Text = line.text
+			text.Color = line.color
+			text.Refresh()
+		},
+	)
+}
+
+// renderOutput drains guiLogQueue into the model once per frame and refreshes
+// list if anything changed. It runs for the life of the window.
+func renderOutput(list *widget.List) {
+	ticker := time.NewTicker(guiFrameInterval)
+	defer ticker.Stop()
+
+	for range ticker.C {
+		started := time.Now()
+		changed := false
+	drain:
+		for {
+			select {
+			case line := <-guiLogQueue:
+				guiLog.apply(line)
+				changed = true
+			default:
+				break drain
+			}
+		}
+		if changed {
+			list.Refresh()
+			list.ScrollToBottom()
+			guiRenderTime.Add(int64(time.Since(started)))
+			guiFrames.Add(1)
+		}
+	}
+}
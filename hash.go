@@ -0,0 +1,149 @@
+package main
+
+import (
+	"context"
+	"crypto/sha1"
+	"encoding/hex"
+	"io"
+	"io/fs"
+	"sync"
+)
+
+// hashChunkSize is the read size used when hashing. Large reads keep slow
+// disks (spinning drives behind USB adapters in particular) streaming.
+const hashChunkSize = 1 << 20
+
+// hashBuffers is the number of chunks in flight per file: one being hashed
+// while the next ones are read.
+const hashBuffers = 3
+
+var hashBufferPool = sync.Pool{
+	New: func() interface{} {
+		buf := make([]byte, hashChunkSize)
+		return &buf
+	},
+}
+
+var (
+	deviceSlotsMu sync.Mutex
+	deviceSlots   = make(map[string]chan struct{})
+)
+
+// hashSlotsFor returns the semaphore bounding concurrent hashing on device,
+// shared by every scan reading from it.
+func hashSlotsFor(device string) chan struct{} {
+	deviceSlotsMu.Lock()
+	defer deviceSlotsMu.Unlock()
+
+	slots, ok := deviceSlots[device]
+	if !ok {
+		jobs := hashJobs
+		if jobs < 1 {
+			jobs = 1
+		}
+		slots = make(chan struct{}, jobs)
+		deviceSlots[device] = slots
+	}
+	return slots
+}
+
+// getSHA1Hash returns the SHA1 of name and the number of bytes hashed,
+// giving up between chunks once ctx is done. crypto/sha1 picks the fastest
+// block implementation for the CPU itself.
+func getSHA1Hash(ctx context.Context, fsys fs.FS, name string) (string, int64, error) {
+	file, err := fsys.Open(name)
+	if err != nil {
+		return "", 0, err
+	}
+	defer file.Close()
+
+	sum, n, err := hashReader(ctx, file)
+	if err != nil {
+		return "", n, err
+	}
+	return hex.EncodeToString(sum), n, nil
+}
+
+// hashReader hashes r. Files larger than one chunk are read ahead on a
+// separate goroutine, so reading the next chunk overlaps hashing this one.
+func hashReader(ctx context.Context, r io.Reader) ([]byte, int64, error) {
+	if err := ctx.Err(); err != nil {
+		return nil, 0, err
+	}
+	hash := sha1.New()
+
+	first := hashBufferPool.Get().(*[]byte)
+	n, err := io.ReadFull(r, *first)
+	hash.Write((*first)[:n])
+	hashBufferPool.Put(first)
+	total := int64(n)
+	if err == io.EOF || err == io.ErrUnexpectedEOF {
+		return hash.Sum(nil), total, nil
+	}
+	if err != nil {
+		return nil, total, err
+	}
+
+	full := make(chan []byte, hashBuffers)
+	free := make(chan *[]byte, hashBuffers)
+	for i := 0; i < hashBuffers; i++ {
+		free <- hashBufferPool.Get().(*[]byte)
+	}
+
+	// stop tells the reader to give up; free always has room for the
+	// buffer it holds, so it never blocks handing it back
+	stop := make(chan struct{})
+	var readErr error
+	go func() {
+		defer close(full)
+		for {
+			var buf *[]byte
+			select {
+			case buf = <-free:
+			case <-stop:
+				return
+			}
+			n, err := io.ReadFull(r, *buf)
+			if n > 0 {
+				select {
+				case full <- (*buf)[:n]:
+				case <-stop:
+					free <- buf
+					return
+				}
+			} else {
+				free <- buf
+			}
+			if err != nil {
+				if err != io.EOF && err != io.ErrUnexpectedEOF {
+					readErr = err
+				}
+				return
+			}
+		}
+	}()
+
+	var cancelled error
+	for chunk := range full {
+		if cancelled == nil {
+			if cancelled = ctx.Err(); cancelled != nil {
+				close(stop)
+			} else {
+				hash.Write(chunk)
+				total += int64(len(chunk))
+			}
+		}
+		buf := chunk[:cap(chunk)]
+		free <- &buf
+	}
+	for i := 0; i < hashBuffers; i++ {
+		hashBufferPool.Put(<-free)
+	}
+	if cancelled != nil {
+		return nil, total, cancelled
+	}
+	if readErr != nil {
+		return nil, total, readErr
+	}
+	return hash.Sum(nil), total, nil
+}
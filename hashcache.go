@@ -0,0 +1,131 @@
+package main
+
+import (
+	"encoding/json"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"runtime"
+	"strings"
+	"sync"
+)
+
+const hashCacheFileName = "hash_cache.json"
+
+type hashCacheEntry struct {
+	Size    int64  `json:"size"`
+	ModTime int64  `json:"mtime"`
+	SHA1    string `json:"sha1"`
+}
+
+// hashCache remembers the SHA1 of every file hashed by a scan, so unchanged
+// files (same path, size and modification time) are not read again.
+type hashCache struct {
+	mu      sync.Mutex
+	path    string
+	entries map[string]hashCacheEntry
+	dirty   bool
+}
+
+var (
+	sharedHashCache     *hashCache
+	sharedHashCacheOnce sync.Once
+)
+
+// openHashCache returns the process-wide hash cache, loading it from the data
+// folder on first use. Scans running at the same time share it.
+func openHashCache() *hashCache {
+	sharedHashCacheOnce.Do(func() {
+		sharedHashCache = loadHashCache(filepath.Join(dataPath, hashCacheFileName))
+	})
+	return sharedHashCache
+}
+
+// loadHashCache reads the cache at path. A missing or unreadable cache is
+// not an error, the scan simply starts with an empty one.
+func loadHashCache(path string) *hashCache {
+	c := &hashCache{
+		path:    path,
+		entries: make(map[string]hashCacheEntry),
+	}
+
+	data, err := os.ReadFile(path)
+	if err != nil {
+		return c
+	}
+	if err := json.Unmarshal(data, &c.entries); err != nil {
+		c.entries = make(map[string]hashCacheEntry)
+	}
+	return c
+}
+
+func normalizeCachePath(filePath string) string {
+	if abs, err := filepath.Abs(filePath); err == nil {
+		filePath = abs
+	}
+	filePath = filepath.ToSlash(filepath.Clean(filePath))
+	if runtime.GOOS == "windows" {
+		filePath = strings.ToLower(filePath)
+	}
+	return filePath
+}
+
+// lookup returns the cached hash for key (see dumpSource.cacheKey) if the
+// file still matches info.
+func (c *hashCache) lookup(key string, info fs.FileInfo) (string, bool) {
+	return c.lookupStamp(key, info.Size(), info.ModTime().UnixNano())
+}
+
+func (c *hashCache) store(key string, info fs.FileInfo, sum string) {
+	c.storeStamp(key, info.Size(), info.ModTime().UnixNano(), sum)
+}
+
+// lookupStamp is lookup for entries that are not a single file, such as
+// content fingerprints, whose stamp stands in for the modification time.
+func (c *hashCache) lookupStamp(key string, size, stamp int64) (string, bool) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	entry, ok := c.entries[key]
+	if ok && entry.Size == size && entry.ModTime == stamp {
+		return entry.SHA1, true
+	}
+	return "", false
+}
+
+func (c *hashCache) storeStamp(key string, size, stamp int64, sum string) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	c.entries[key] = hashCacheEntry{
+		Size:    size,
+		ModTime: stamp,
+		SHA1:    sum,
+	}
+	c.dirty = true
+}
+
+// save writes the cache back to disk if anything was added since it was
+// loaded. It is written under a temporary name first, so a crash or a full
+// disk never leaves a truncated cache behind.
+func (c *hashCache) save() error {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	if !c.dirty {
+		return nil
+	}
+	data, err := json.Marshal(c.entries)
+	if err != nil {
+		return err
+	}
+	tmpPath := c.path + ".tmp"
+	if err := os.WriteFile(tmpPath, data, 0o644); err != nil {
+		return err
+	}
+	if err := os.Rename(tmpPath, c.path); err != nil {
+		return err
+	}
+	c.dirty = false
+	return nil
+}
@@ -0,0 +1,170 @@
+package main
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"io/fs"
+	"strings"
+	"time"
+	"unicode/utf16"
+)
+
+// headerReadSize is how much of a file the header parsers read. One read
+// covers the image header and certificate of a retail XBE and the fixed
+// part and names of a contentmeta.xbx, so metadata costs an open and a
+// few KB instead of a full read.
+const headerReadSize = 4096
+
+var errNoHeader = errors.New("no recognised header")
+
+// xbeHeader is what a scan reports from an XBE certificate.
+type xbeHeader struct {
+	TitleID   string    `json:"titleId"`
+	TitleName string    `json:"titleName,omitempty"`
+	Version   uint32    `json:"version"`
+	Built     time.Time `json:"built"` // certificate timestamp
+}
+
+func (x *xbeHeader) String() string {
+	text := fmt.Sprintf("%s, version %d, built %s", x.TitleID, x.Version, x.Built.UTC().Format("2006-01-02"))
+	if x.TitleName != "" {
+		text = x.TitleName + " (" + text + ")"
+	}
+	return text
+}
+
+// contentMeta is what a scan reports from a contentmeta.xbx.
+type contentMeta struct {
+	TitleID     string
+	OfferID     string // the content ID the file was signed for
+	DisplayName string
+}
+
+// readAt reads len(buf) bytes at off, or fewer at the end of the file. Files
+// that cannot seek (compressed zip entries) can only be read from the start.
+func readAt(f fs.File, buf []byte, off int64) (int, error) {
+	if ra, ok := f.(io.ReaderAt); ok {
+		n, err := ra.ReadAt(buf, off)
+		if err == io.EOF {
+			err = nil
+		}
+		return n, err
+	}
+	if off != 0 {
+		return 0, errNoHeader
+	}
+	n, err := io.ReadFull(f, buf)
+	if err == io.EOF || err == io.ErrUnexpectedEOF {
+		err = nil
+	}
+	return n, err
+}
+
+// readXBEHeader reads the certificate of the XBE name. The image header
+// starts with "XBEH"; at 0x104 it holds the base address the image is
+// loaded at and at 0x118 the address of the certificate, which holds the
+// timestamp at 0x04, title ID at 0x08, title name (40 UTF-16 characters) at
+// 0x0C and version at 0xAC. Files that are not XBEs return errNoHeader.
+func readXBEHeader(fsys fs.FS, name string) (*xbeHeader, error) {
+	f, err := fsys.Open(name)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	buf := make([]byte, headerReadSize)
+	n, err := readAt(f, buf, 0)
+	if err != nil {
+		return nil, err
+	}
+	buf = buf[:n]
+	if len(buf) < 0x178 || string(buf[:4]) != "XBEH" {
+		return nil, errNoHeader
+	}
+	base := binary.LittleEndian.Uint32(buf[0x104:])
+	certAddr := binary.LittleEndian.Uint32(buf[0x118:])
+	if certAddr < base {
+		return nil, errNoHeader
+	}
+	off := int64(certAddr - base)
+
+	const certSize = 0xB0
+	var cert []byte
+	if off+certSize <= int64(len(buf)) {
+		cert = buf[off : off+certSize]
+	} else {
+		// Not in the first read: headers padded by an unusual linker
+		cert = make([]byte, certSize)
+		if n, err := readAt(f, cert, off); err != nil || n < certSize {
+			return nil, errNoHeader
+		}
+	}
+
+	return &xbeHeader{
+		TitleID:   fmt.Sprintf("%08x", binary.LittleEndian.Uint32(cert[0x08:])),
+		TitleName: utf16Field(cert[0x0C:0x5C]),
+		Version:   binary.LittleEndian.Uint32(cert[0xAC:]),
+		Built:     time.Unix(int64(binary.LittleEndian.Uint32(cert[0x04:])), 0),
+	}, nil
+}
+
+// readContentMeta reads the header of the contentmeta.xbx name. After a 20
+// byte signature comes "XCMT", then the header size, content type, content
+// flags, title ID and the 64-bit offer ID (the content ID); the localized
+// names follow as UTF-16 "Name=" lines, like those of TitleMeta.xbx. Files
+// without the magic return errNoHeader.
+func readContentMeta(fsys fs.FS, name string) (*contentMeta, error) {
+	f, err := fsys.Open(name)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	buf := make([]byte, headerReadSize)
+	n, err := readAt(f, buf, 0)
+	if err != nil {
+		return nil, err
+	}
+	buf = buf[:n]
+	if len(buf) < 0x30 || string(buf[0x14:0x18]) != "XCMT" {
+		return nil, errNoHeader
+	}
+
+	meta := &contentMeta{
+		TitleID: fmt.Sprintf("%08x", binary.LittleEndian.Uint32(buf[0x24:])),
+		OfferID: fmt.Sprintf("%016x", binary.LittleEndian.Uint64(buf[0x28:])),
+	}
+	// The names are not necessarily 2-byte aligned
+	for start := 0x30; start < 0x32 && meta.DisplayName == ""; start++ {
+		meta.DisplayName = findName(decodeUTF16(buf[start:]))
+	}
+	return meta, nil
+}
+
+// findName returns the value of the first "Name=" line of text.
+func findName(text string) string {
+	lines := strings.FieldsFunc(text, func(r rune) bool { return r == '\r' || r == '\n' || r == 0 })
+	for _, line := range lines {
+		if key, value, ok := strings.Cut(line, "="); ok && strings.EqualFold(strings.TrimSpace(key), "Name") {
+			return strings.TrimSpace(value)
+		}
+	}
+	return ""
+}
+
+// decodeUTF16 decodes little-endian UTF-16.
+func decodeUTF16(b []byte) string {
+	units := make([]uint16, 0, len(b)/2)
+	for i := 0; i+1 < len(b); i += 2 {
+		units = append(units, binary.LittleEndian.Uint16(b[i:]))
+	}
+	return string(utf16.Decode(units))
+}
+
+// utf16Field decodes a fixed-size, NUL padded UTF-16 field.
+func utf16Field(b []byte) string {
+	text, _, _ := strings.Cut(decodeUTF16(b), "\x00")
+	return text
+}
@@ -0,0 +1,123 @@
+package main
+
+import (
+	"encoding/binary"
+	"errors"
+	"io/fs"
+	"reflect"
+	"testing"
+	"testing/fstest"
+	"time"
+	"unicode/utf16"
+)
+
+func putUTF16(b []byte, s string) {
+	for i, u := range utf16.Encode([]rune(s)) {
+		binary.LittleEndian.PutUint16(b[2*i:], u)
+	}
+}
+
+// testXBE returns an XBE image of size bytes loaded at 0x10000 with its
+// certificate at certOff, laid out as readXBEHeader documents.
+func testXBE(size, certOff int) []byte {
+	const base = 0x10000
+	b := make([]byte, size)
+	copy(b, "XBEH")
+	binary.LittleEndian.PutUint32(b[0x104:], base)
+	binary.LittleEndian.PutUint32(b[0x118:], uint32(base+certOff))
+	cert := b[certOff:]
+	binary.LittleEndian.PutUint32(cert[0x04:], 1100000000)
+	binary.LittleEndian.PutUint32(cert[0x08:], 0x4d530004)
+	putUTF16(cert[0x0C:0x5C], "Halo 2")
+	binary.LittleEndian.PutUint32(cert[0xAC:], 0x00000003)
+	return b
+}
+
+// testContentMeta returns a contentmeta.xbx whose UTF-16 names start at
+// nameOff.
+func testContentMeta(nameOff int, names string) []byte {
+	b := make([]byte, nameOff+2*len(names)+2)
+	copy(b[0x14:], "XCMT")
+	binary.LittleEndian.PutUint32(b[0x18:], 0x30)
+	binary.LittleEndian.PutUint32(b[0x24:], 0x4d530004)
+	binary.LittleEndian.PutUint64(b[0x28:], 0x4d53000400000001)
+	putUTF16(b[nameOff:], names)
+	return b
+}
+
+// streamFS hides io.ReaderAt, like the compressed entries of a zip.
+type streamFS struct{ fs.FS }
+
+type streamFile struct{ fs.File }
+
+func (s streamFS) Open(name string) (fs.File, error) {
+	f, err := s.FS.Open(name)
+	if err != nil {
+		return nil, err
+	}
+	return streamFile{f}, nil
+}
+
+func TestReadXBEHeader(t *testing.T) {
+	halo2 := &xbeHeader{TitleID: "4d530004", TitleName: "Halo 2", Version: 3, Built: time.Unix(1100000000, 0)}
+	fsys := fstest.MapFS{
+		"default.xbe": {Data: testXBE(0x1000, 0x178)},
+		"padded.xbe":  {Data: testXBE(0x3000, 0x2000)},
+		"short.xbe":   {Data: testXBE(0x178, 0x0)[:0x177]},
+		"text.xbe":    {Data: []byte("not an executable")},
+		"before.xbe":  {Data: func() []byte { b := testXBE(0x1000, 0x178); binary.LittleEndian.PutUint32(b[0x118:], 0x100); return b }()},
+	}
+
+	tests := []struct {
+		name string
+		fsys fs.FS
+		want *xbeHeader
+		err  error
+	}{
+		{"default.xbe", fsys, halo2, nil},
+		{"default.xbe", streamFS{fsys}, halo2, nil},
+		{"padded.xbe", fsys, halo2, nil},
+		{"padded.xbe", streamFS{fsys}, nil, errNoHeader}, // cannot seek to the certificate
+		{"short.xbe", fsys, nil, errNoHeader},
+		{"text.xbe", fsys, nil, errNoHeader},
+		{"before.xbe", fsys, nil, errNoHeader},
+		{"missing.xbe", fsys, nil, fs.ErrNotExist},
+	}
+	for _, test := range tests {
+		got, err := readXBEHeader(test.fsys, test.name)
+		if !errors.Is(err, test.err) || !reflect.DeepEqual(got, test.want) {
+			t.Errorf("readXBEHeader(%T, %s) = %+v, %v; want %+v, %v", test.fsys, test.name, got, err, test.want, test.err)
+		}
+	}
+
+	if text, want := halo2.String(), "Halo 2 (4d530004, version 3, built 2004-11-09)"; text != want {
+		t.Errorf("String() = %q, want %q", text, want)
+	}
+}
+
+func TestReadContentMeta(t *testing.T) {
+	fsys := fstest.MapFS{
+		"aligned.xbx":   {Data: testContentMeta(0x30, "Name=Multiplayer Map Pack\r\nPublisher=Bungie\r\n")},
+		"unaligned.xbx": {Data: testContentMeta(0x31, "Publisher=Bungie\r\nname = Multiplayer Map Pack\r\n")},
+		"nameless.xbx":  {Data: testContentMeta(0x30, "Publisher=Bungie")},
+		"text.xbx":      {Data: make([]byte, 0x100)},
+	}
+
+	mapPack := &contentMeta{TitleID: "4d530004", OfferID: "4d53000400000001", DisplayName: "Multiplayer Map Pack"}
+	tests := []struct {
+		name string
+		want *contentMeta
+		err  error
+	}{
+		{"aligned.xbx", mapPack, nil},
+		{"unaligned.xbx", mapPack, nil},
+		{"nameless.xbx", &contentMeta{TitleID: "4d530004", OfferID: "4d53000400000001"}, nil},
+		{"text.xbx", nil, errNoHeader},
+	}
+	for _, test := range tests {
+		got, err := readContentMeta(fsys, test.name)
+		if !errors.Is(err, test.err) || !reflect.DeepEqual(got, test.want) {
+			t.Errorf("readContentMeta(%s) = %+v, %v; want %+v, %v", test.name, got, err, test.want, test.err)
+		}
+	}
+}
@@ -0,0 +1,490 @@
+package main
+
+import (
+	"bytes"
+	"crypto/sha1"
+	"encoding/hex"
+	"fmt"
+	"sort"
+	"strconv"
+	"strings"
+)
+
+// titleIndex is the database as the scanner queries it, packed into sorted
+// arrays: title IDs are interned into one sorted table, content IDs are
+// 64-bit integers, SHA1s are [20]byte and archived and update names are
+// interned, so lookups are binary searches over a few flat slices instead of
+// walks or map lookups over hundreds of small maps and strings.
+type titleIndex struct {
+	titles       []indexedTitle     // sorted by ID
+	names        []string           // interned archived and update names
+	content      []indexedContent   // sorted by title, then content ID
+	fingerprints [][sha1.Size]byte  // from "Content Fingerprints"
+	updates      []indexedUpdate    // sorted by SHA1, then title
+	updateSizes  []int64            // every size in "Title Update Sizes", sorted
+	irregular    []irregularContent // content IDs or fingerprints that are not hex, sorted
+	sized        bool               // every known update in the database has a size recorded
+
+	// -stats totals: the distinct keys of every "Title Updates Known" and
+	// "Archived" map, as they are spelled in the database
+	knownUpdateKeys int
+	archivedKeys    int
+}
+
+type indexedTitle struct {
+	id    string // lowercased
+	stats titleCounts
+	sized bool // every known update of the title has a size recorded
+}
+
+// indexedContent is a content ID listed under "Content IDs", "Archived" or
+// "Content Fingerprints" of a title.
+type indexedContent struct {
+	id          uint64
+	title       uint32 // in titles
+	name        uint32 // archived name + 1 in names, 0 if not archived
+	fingerprint uint32 // + 1 in fingerprints, 0 if none is recorded
+	known       bool   // listed under "Content IDs"
+}
+
+// indexedUpdate is a known title update SHA1 filed under a title.
+type indexedUpdate struct {
+	sum   [sha1.Size]byte
+	title uint32 // in titles
+	name  uint32 // in names
+}
+
+// irregularContent is what the packed tables cannot hold, such as a content
+// ID of the wrong length; the database is community maintained.
+type irregularContent struct {
+	title       uint32
+	id          string
+	name        string
+	fingerprint string
+	archived    bool
+	known       bool
+}
+
+// knownUpdate is a title update SHA1 as it is filed in the database.
+type knownUpdate struct {
+	titleID string
+	name    string
+}
+
+// contentInfo is what the database records about a content ID of a title.
+type contentInfo struct {
+	known       bool
+	archived    bool
+	name        string
+	fingerprint string
+}
+
+// parseContentID parses a 16 digit hex content ID.
+func parseContentID(contentID string) (uint64, bool) {
+	if len(contentID) != 16 {
+		return 0, false
+	}
+	id, err := strconv.ParseUint(contentID, 16, 64)
+	return id, err == nil
+}
+
+// parseSHA1 parses a 40 digit hex SHA1.
+func parseSHA1(hash string) (sum [sha1.Size]byte, ok bool) {
+	if len(hash) != 2*sha1.Size {
+		return sum, false
+	}
+	_, err := hex.Decode(sum[:], []byte(hash))
+	return sum, err == nil
+}
+
+// indexBuilder interns titles and names while an index is built.
+type indexBuilder struct {
+	idx    *titleIndex
+	titles map[string]uint32
+	names  map[string]uint32
+}
+
+func (b *indexBuilder) name(name string) uint32 {
+	n, ok := b.names[name]
+	if !ok {
+		n = uint32(len(b.idx.names))
+		b.idx.names = append(b.idx.names, name)
+		b.names[name] = n
+	}
+	return n
+}
+
+// buildIndex (re)builds the lookup tables. It must be called whenever Titles
+// is replaced; loadJSONData does this after every successful decode. Titles
+// is then trimmed to the title names, as everything else is answered by the
+// index, which also makes up the database snapshot.
+func (t *TitleList) buildIndex() {
+	idx := &titleIndex{}
+	b := &indexBuilder{idx: idx, titles: make(map[string]uint32), names: make(map[string]uint32)}
+
+	ids := make([]string, 0, len(t.Titles))
+	for titleID := range t.Titles {
+		ids = append(ids, strings.ToLower(titleID))
+	}
+	sort.Strings(ids)
+	for _, id := range ids {
+		if _, ok := b.titles[id]; !ok {
+			b.titles[id] = uint32(len(idx.titles))
+			idx.titles = append(idx.titles, indexedTitle{id: id})
+		}
+	}
+
+	irregular := make(map[titleContentKey]*irregularContent)
+	irregularOf := func(title uint32, contentID string) *irregularContent {
+		key := titleContentKey{idx.titles[title].id, contentID}
+		c, ok := irregular[key]
+		if !ok {
+			c = &irregularContent{title: title, id: contentID}
+			irregular[key] = c
+		}
+		return c
+	}
+	addContent := func(title uint32, contentID string, set func(*indexedContent), setIrregular func(*irregularContent)) {
+		contentID = strings.ToLower(contentID)
+		if id, ok := parseContentID(contentID); ok {
+			c := indexedContent{id: id, title: title}
+			set(&c)
+			idx.content = append(idx.content, c)
+			return
+		}
+		setIrregular(irregularOf(title, contentID))
+	}
+
+	sizes := make(map[int64]struct{})
+	idx.sized = true
+	knownUpdateKeys := make(map[string]struct{})
+	archivedKeys := make(map[string]struct{})
+	for titleID, data := range t.Titles {
+		title := b.titles[strings.ToLower(titleID)]
+		stats := &idx.titles[title].stats
+		stats.contentIDs += len(data.ContentIDs)
+		stats.titleUpdates += len(data.TitleUpdates)
+		stats.knownUpdates += len(data.TitleUpdatesKnown)
+		stats.archived += len(data.Archived)
+
+		for _, contentID := range data.ContentIDs {
+			addContent(title, contentID,
+				func(c *indexedContent) { c.known = true },
+				func(c *irregularContent) { c.known = true })
+		}
+		for _, archived := range data.Archived {
+			for contentID, name := range archived {
+				archivedKeys[contentID] = struct{}{}
+				addContent(title, contentID,
+					func(c *indexedContent) { c.name = b.name(name) + 1 },
+					func(c *irregularContent) {
+						if !c.archived {
+							c.archived, c.name = true, name
+						}
+					})
+			}
+		}
+		for contentID, fingerprint := range data.Fingerprints {
+			fingerprint = strings.ToLower(fingerprint)
+			sum, ok := parseSHA1(fingerprint)
+			if !ok {
+				irregularOf(title, strings.ToLower(contentID)).fingerprint = fingerprint
+				continue
+			}
+			addContent(title, contentID,
+				func(c *indexedContent) {
+					idx.fingerprints = append(idx.fingerprints, sum)
+					c.fingerprint = uint32(len(idx.fingerprints))
+				},
+				func(c *irregularContent) { c.fingerprint = fingerprint })
+		}
+
+		sized := make(map[[sha1.Size]byte]struct{}, len(data.TitleUpdateSizes))
+		for hash, size := range data.TitleUpdateSizes {
+			if sum, ok := parseSHA1(strings.ToLower(hash)); ok {
+				sized[sum] = struct{}{}
+			}
+			sizes[size] = struct{}{}
+		}
+		known, withSize := 0, 0
+		for _, updates := range data.TitleUpdatesKnown {
+			for hash, name := range updates {
+				knownUpdateKeys[hash] = struct{}{}
+				known++
+				// A malformed SHA1 can never match a hashed file
+				sum, ok := parseSHA1(strings.ToLower(hash))
+				if !ok {
+					continue
+				}
+				idx.updates = append(idx.updates, indexedUpdate{sum: sum, title: title, name: b.name(name)})
+				if _, ok := sized[sum]; ok {
+					withSize++
+				}
+			}
+		}
+		if known > 0 && withSize == known {
+			idx.titles[title].sized = true
+		}
+		if withSize != known {
+			idx.sized = false
+		}
+	}
+
+	idx.knownUpdateKeys, idx.archivedKeys = len(knownUpdateKeys), len(archivedKeys)
+	idx.content = mergeContent(idx.content)
+	sort.Slice(idx.updates, func(i, j int) bool {
+		a, b := &idx.updates[i], &idx.updates[j]
+		if c := bytes.Compare(a.sum[:], b.sum[:]); c != 0 {
+			return c < 0
+		}
+		return a.title < b.title
+	})
+	for size := range sizes {
+		idx.updateSizes = append(idx.updateSizes, size)
+	}
+	sort.Slice(idx.updateSizes, func(i, j int) bool { return idx.updateSizes[i] < idx.updateSizes[j] })
+	for _, c := range irregular {
+		idx.irregular = append(idx.irregular, *c)
+	}
+	sort.Slice(idx.irregular, func(i, j int) bool {
+		a, b := &idx.irregular[i], &idx.irregular[j]
+		return a.title < b.title || a.title == b.title && a.id < b.id
+	})
+
+	for titleID, data := range t.Titles {
+		t.Titles[titleID] = TitleData{TitleName: data.TitleName}
+	}
+	t.index = idx
+}
+
+// mergeContent sorts content and merges the entries of each content ID. For
+// an ID archived under several names, the name first listed is kept.
+func mergeContent(content []indexedContent) []indexedContent {
+	sort.SliceStable(content, func(i, j int) bool {
+		a, b := &content[i], &content[j]
+		return a.title < b.title || a.title == b.title && a.id < b.id
+	})
+	merged := content[:0]
+	for _, c := range content {
+		if n := len(merged); n > 0 && merged[n-1].title == c.title && merged[n-1].id == c.id {
+			last := &merged[n-1]
+			last.known = last.known || c.known
+			if last.name == 0 {
+				last.name = c.name
+			}
+			if last.fingerprint == 0 {
+				last.fingerprint = c.fingerprint
+			}
+			continue
+		}
+		merged = append(merged, c)
+	}
+	return merged[:len(merged):len(merged)]
+}
+
+type titleContentKey struct {
+	titleID   string
+	contentID string
+}
+
+// title returns the position of titleID in the title table.
+func (idx *titleIndex) title(titleID string) (uint32, bool) {
+	i := sort.Search(len(idx.titles), func(i int) bool { return idx.titles[i].id >= titleID })
+	return uint32(i), i < len(idx.titles) && idx.titles[i].id == titleID
+}
+
+// lookupContent returns what the database records about contentID of titleID.
+func (t *TitleList) lookupContent(titleID, contentID string) contentInfo {
+	var info contentInfo
+	idx := t.index
+	if idx == nil {
+		return info
+	}
+	title, ok := idx.title(titleID)
+	if !ok {
+		return info
+	}
+
+	if id, ok := parseContentID(contentID); ok {
+		i := sort.Search(len(idx.content), func(i int) bool {
+			c := &idx.content[i]
+			return c.title > title || c.title == title && c.id >= id
+		})
+		if i < len(idx.content) && idx.content[i].title == title && idx.content[i].id == id {
+			c := &idx.content[i]
+			info.known, info.archived = c.known, c.name != 0
+			if info.archived {
+				info.name = idx.names[c.name-1]
+			}
+			if c.fingerprint != 0 {
+				info.fingerprint = hex.EncodeToString(idx.fingerprints[c.fingerprint-1][:])
+			}
+		}
+	}
+
+	if len(idx.irregular) == 0 {
+		return info
+	}
+	i := sort.Search(len(idx.irregular), func(i int) bool {
+		c := &idx.irregular[i]
+		return c.title > title || c.title == title && c.id >= contentID
+	})
+	if i < len(idx.irregular) && idx.irregular[i].title == title && idx.irregular[i].id == contentID {
+		c := &idx.irregular[i]
+		info.known = info.known || c.known
+		if c.archived && !info.archived {
+			info.archived, info.name = true, c.name
+		}
+		if info.fingerprint == "" {
+			info.fingerprint = c.fingerprint
+		}
+	}
+	return info
+}
+
+func (t *TitleList) isKnownContent(titleID, contentID string) bool {
+	return t.lookupContent(titleID, contentID).known
+}
+
+func (t *TitleList) archivedName(titleID, contentID string) (string, bool) {
+	info := t.lookupContent(titleID, contentID)
+	return info.name, info.archived
+}
+
+// recordedFingerprint returns the fingerprint recorded for the content, if any.
+func (t *TitleList) recordedFingerprint(titleID, contentID string) (string, bool) {
+	info := t.lookupContent(titleID, contentID)
+	return info.fingerprint, info.fingerprint != ""
+}
+
+// mayBeKnownUpdate reports whether a file of the given size in titleID's
+// update folder could hash to a known update. It only rules a file out when
+// the title has known updates, every known update in the database has a
+// size, and none has this one. A file may be an update misfiled under
+// another title, so one unsized update anywhere keeps every file hashed.
+func (t *TitleList) mayBeKnownUpdate(titleID string, size int64) bool {
+	if t.index == nil || !t.index.sized {
+		return true
+	}
+	if title, ok := t.index.title(titleID); !ok || !t.index.titles[title].sized {
+		return true
+	}
+	sizes := t.index.updateSizes
+	i := sort.Search(len(sizes), func(i int) bool { return sizes[i] >= size })
+	return i < len(sizes) && sizes[i] == size
+}
+
+// findUpdate looks up a title update SHA1. If the hash is filed under titleID
+// that entry is returned with ok set; otherwise the first title it is filed
+// under (if any) is returned with ok cleared, so misfiled updates can be flagged.
+func (t *TitleList) findUpdate(titleID, hash string) (update knownUpdate, ok bool, elsewhere bool) {
+	idx := t.index
+	if idx == nil {
+		return knownUpdate{}, false, false
+	}
+	sum, valid := parseSHA1(hash)
+	if !valid {
+		return knownUpdate{}, false, false
+	}
+	i := sort.Search(len(idx.updates), func(i int) bool { return bytes.Compare(idx.updates[i].sum[:], sum[:]) >= 0 })
+	first := i
+	for ; i < len(idx.updates) && idx.updates[i].sum == sum; i++ {
+		if idx.titles[idx.updates[i].title].id == titleID {
+			return idx.knownUpdate(i), true, false
+		}
+	}
+	if i > first {
+		return idx.knownUpdate(first), false, true
+	}
+	return knownUpdate{}, false, false
+}
+
+func (idx *titleIndex) knownUpdate(i int) knownUpdate {
+	u := &idx.updates[i]
+	return knownUpdate{titleID: idx.titles[u.title].id, name: idx.names[u.name]}
+}
+
+// contentStatus classifies contentID of titleID the way a scan does, and
+// returns the name it is archived under.
+func (t *TitleList) contentStatus(titleID, contentID string) (findingStatus, string) {
+	info := t.lookupContent(titleID, contentID)
+	if !info.known {
+		return statusUnknown, ""
+	}
+	if info.name != "" {
+		return statusArchived, info.name
+	}
+	return statusUnarchived, ""
+}
+
+// updateStatus classifies a title update SHA1 found under titleID the way a
+// scan does. With an empty titleID, for files found outside TDATA, an update
+// filed under any title is known.
+func (t *TitleList) updateStatus(titleID, hash string) (findingStatus, knownUpdate) {
+	update, known, elsewhere := t.findUpdate(titleID, hash)
+	switch {
+	case known || elsewhere && titleID == "":
+		return statusArchived, update
+	case elsewhere:
+		return statusMisfiled, update
+	}
+	return statusUnknown, update
+}
+
+// titleCounts are the -stats figures of one title or the whole database.
+// They count the entries of the JSON as it is written, malformed or not:
+// for a title, the lengths of its lists; for the database, the sum of the
+// titles' lists except for known updates and archived items, which are the
+// distinct SHA1s and content IDs listed by any title.
+type titleCounts struct {
+	contentIDs   int
+	titleUpdates int
+	knownUpdates int
+	archived     int
+}
+
+// counts returns the figures of titleID, or of every title if titleID is empty.
+func (t *TitleList) counts(titleID string) titleCounts {
+	var n titleCounts
+	idx := t.index
+	if idx == nil {
+		return n
+	}
+	if titleID != "" {
+		if title, ok := idx.title(titleID); ok {
+			n = idx.titles[title].stats
+		}
+		return n
+	}
+	for _, title := range idx.titles {
+		n.contentIDs += title.stats.contentIDs
+		n.titleUpdates += title.stats.titleUpdates
+	}
+	n.knownUpdates, n.archived = idx.knownUpdateKeys, idx.archivedKeys
+	return n
+}
+
+// contentIDs returns the known content IDs of titleID, in order.
+func (t *TitleList) contentIDs(titleID string) []string {
+	idx := t.index
+	if idx == nil {
+		return nil
+	}
+	title, ok := idx.title(titleID)
+	if !ok {
+		return nil
+	}
+	var ids []string
+	i := sort.Search(len(idx.content), func(i int) bool { return idx.content[i].title >= title })
+	for ; i < len(idx.content) && idx.content[i].title == title; i++ {
+		if idx.content[i].known {
+			ids = append(ids, fmt.Sprintf("%016x", idx.content[i].id))
+		}
+	}
+	for _, c := range idx.irregular {
+		if c.title == title && c.known {
+			ids = append(ids, c.id)
+		}
+	}
+	return ids
+}
@@ -0,0 +1,65 @@
+package main
+
+import "testing"
+
+// TestCounts checks that -stats counts the database as it is written, like
+// it did before the index was packed.
+func TestCounts(t *testing.T) {
+	titles := newTestTitleList()
+	tests := []struct {
+		titleID string
+		want    titleCounts
+	}{
+		{"4d530004", titleCounts{contentIDs: 3, titleUpdates: 2, knownUpdates: 2, archived: 2}},
+		{"41560017", titleCounts{contentIDs: 1, knownUpdates: 2}},
+		{"00000000", titleCounts{}},
+		// Known updates and archived items count each key once, including
+		// the malformed SHA1 and the short content ID
+		{"", titleCounts{contentIDs: 4, titleUpdates: 2, knownUpdates: 3, archived: 2}},
+	}
+	for _, test := range tests {
+		if got := titles.counts(test.titleID); got != test.want {
+			t.Errorf("counts(%q) = %+v, want %+v", test.titleID, got, test.want)
+		}
+	}
+}
+
+func TestMayBeKnownUpdate(t *testing.T) {
+	halo2 := TitleData{
+		TitleUpdatesKnown: []map[string]string{{"0123456789abcdef0123456789abcdef01234567": "default.xbe"}},
+		TitleUpdateSizes:  map[string]int64{"0123456789abcdef0123456789abcdef01234567": 1 << 20},
+	}
+	titles := &TitleList{Titles: map[string]TitleData{
+		"4d530004": halo2,
+		"41560017": {
+			TitleUpdatesKnown: []map[string]string{{"89abcdef0123456789abcdef0123456789abcdef": "default.xbe"}},
+			TitleUpdateSizes:  map[string]int64{"89abcdef0123456789abcdef0123456789abcdef": 2 << 20},
+		},
+	}}
+	titles.buildIndex()
+	for _, test := range []struct {
+		size int64
+		want bool
+	}{
+		{1 << 20, true},
+		{2 << 20, true}, // may be the other title's update, misfiled
+		{3 << 20, false},
+	} {
+		if got := titles.mayBeKnownUpdate("4d530004", test.size); got != test.want {
+			t.Errorf("mayBeKnownUpdate(%d) = %v, want %v", test.size, got, test.want)
+		}
+	}
+	if !titles.mayBeKnownUpdate("00000000", 3<<20) {
+		t.Errorf("ruled out an update of a title with no known updates")
+	}
+
+	// An update without a size, filed under another title, may have any size
+	unsized := &TitleList{Titles: map[string]TitleData{
+		"4d530004": halo2,
+		"41560017": {TitleUpdatesKnown: []map[string]string{{"89abcdef0123456789abcdef0123456789abcdef": "default.xbe"}}},
+	}}
+	unsized.buildIndex()
+	if !unsized.mayBeKnownUpdate("4d530004", 3<<20) {
+		t.Errorf("ruled out an update while another title's update has no size")
+	}
+}
@@ -1,104 +1,250 @@
 package main
 
 import (
+	"bytes"
+	"context"
 	"crypto/sha1"
+	"encoding/hex"
 	"encoding/json"
 	"fmt"
 	"io"
 	"net/http"
 	"os"
-	"regexp"
+	"path/filepath"
+	"reflect"
+	"sync/atomic"
 
 	"fyne.io/fyne/v2/theme"
 )
 
-func removeCommentsFromJSON(jsonStr string) string {
-	// remove // style comments
-	re := regexp.MustCompile(`(?m)^[ \t]*//.*\n?`)
-	jsonStr = re.ReplaceAllString(jsonStr, "")
+// decodeJSONData strips comments from data and decodes it into v, see
+// decodeJSON.
+func decodeJSONData(jsonFilePath string, data []byte, v interface{}) error {
+	return decodeJSON(jsonFilePath, sha1.Sum(data), bytes.NewReader(data), v)
+}
 
-	// remove /* ... */ style comments
-	re = regexp.MustCompile(`/\*[\s\S]*?\*/`)
-	jsonStr = re.ReplaceAllString(jsonStr, "")
+// decodeJSONFile decodes the JSON file at jsonFilePath into v, streaming it
+// from disk rather than reading it into memory first.
+func decodeJSONFile(jsonFilePath string, v interface{}) error {
+	file, err := os.Open(jsonFilePath)
+	if err != nil {
+		return err
+	}
+	defer file.Close()
 
-	return jsonStr
+	sum, _, err := hashReader(context.Background(), file)
+	if err != nil {
+		return err
+	}
+	if _, err := file.Seek(0, io.SeekStart); err != nil {
+		return err
+	}
+	var sourceHash [sha1.Size]byte
+	copy(sourceHash[:], sum)
+	return decodeJSON(jsonFilePath, sourceHash, file, v)
 }
 
-func downloadJSONData(url string) ([]byte, error) {
+// decodeJSON decodes the JSON read from r into v, skipping comments as it
+// goes. Decoded TitleLists get their lookup indexes built straight away, and
+// are loaded from (or saved to) the binary snapshot next to jsonFilePath when
+// possible; sourceHash is the SHA1 of the JSON.
+func decodeJSON(jsonFilePath string, sourceHash [sha1.Size]byte, r io.Reader, v interface{}) error {
+	titleList, isTitleList := v.(*TitleList)
+	if isTitleList && loadSnapshot(jsonFilePath, sourceHash, titleList) == nil {
+		titleList.digest = sourceHash
+		return nil
+	}
+
+	stripped := newCommentStripper(r)
+	if !isTitleList {
+		return json.NewDecoder(stripped).Decode(v)
+	}
+
+	if err := decodeTitleList(stripped, titleList); err != nil {
+		return err
+	}
+	titleList.buildIndex()
+	titleList.digest = sourceHash
+	if err := writeSnapshot(jsonFilePath, sourceHash, titleList); err != nil {
+		fmt.Fprintf(statusOut, "Could not write database snapshot: %v\n", err)
+	}
+	return nil
+}
+
+// titleDB holds the loaded title database. A published TitleList is never
+// modified: loads and updates decode into a new one and swap the pointer, so
+// a running scan keeps the list it started with and the next one picks up
+// the new list.
+var (
+	titleDB        atomic.Pointer[TitleList]
+	titleDBRefresh atomic.Bool // a background refresh is running
+)
+
+// currentTitles returns the published title database, or an empty one if
+// none has been loaded yet.
+func currentTitles() *TitleList {
+	if t := titleDB.Load(); t != nil {
+		return t
+	}
+	return &TitleList{}
+}
+
+// loadTitleDatabase loads jsonFilePath (downloading it first when update is
+// set) into a new TitleList, indexes it and publishes it.
+func loadTitleDatabase(jsonFilePath, path string, update bool) error {
+	t := new(TitleList)
+	if err := loadJSONData(jsonFilePath, "Xbox-Preservation-Project", "Pinecone", path, t, update); err != nil {
+		return err
+	}
+	titleDB.Store(t)
+	return nil
+}
+
+// refreshTitleDatabase downloads and publishes a new database in the
+// background, then calls done with the result. It returns false, without
+// calling done, if a refresh is already running.
+func refreshTitleDatabase(jsonFilePath string, done func(error)) bool {
+	if !titleDBRefresh.CompareAndSwap(false, true) {
+		return false
+	}
+	go func() {
+		defer titleDBRefresh.Store(false)
+		done(loadTitleDatabase(jsonFilePath, jsonFilePath, true))
+	}()
+	return true
+}
+
+// etagPath is where the ETag of the last download of jsonFilePath is kept.
+func etagPath(jsonFilePath string) string {
+	return jsonFilePath + ".etag"
+}
+
+// downloadJSONData fetches url into a temporary file next to jsonFilePath.
+// If jsonFilePath exists, the request carries the ETag of its last download
+// and an unchanged file costs a single 304 round trip, reported as
+// tmpPath == "". Otherwise the body is streamed to disk and hashed on the
+// way; the caller renames tmpPath into place or removes it.
+func downloadJSONData(url, jsonFilePath string) (tmpPath string, sum [sha1.Size]byte, etag string, err error) {
 	req, err := http.NewRequest("GET", url, nil)
 	if err != nil {
-		return nil, err
+		return "", sum, "", err
 	}
 	req.Header.Set("Accept", "application/vnd.github.v3.raw")
+	if _, err := os.Stat(jsonFilePath); err == nil {
+		if etag, err := os.ReadFile(etagPath(jsonFilePath)); err == nil && len(etag) > 0 {
+			req.Header.Set("If-None-Match", string(etag))
+		}
+	}
 
 	resp, err := http.DefaultClient.Do(req)
 	if err != nil {
-		return nil, err
+		return "", sum, "", err
 	}
 	defer resp.Body.Close()
 
-	return io.ReadAll(resp.Body)
+	switch resp.StatusCode {
+	case http.StatusNotModified:
+		return "", sum, "", nil
+	case http.StatusOK:
+	default:
+		return "", sum, "", fmt.Errorf("downloading %s: %s", url, resp.Status)
+	}
+
+	tmp, err := os.CreateTemp(filepath.Dir(jsonFilePath), filepath.Base(jsonFilePath)+".*.tmp")
+	if err != nil {
+		return "", sum, "", err
+	}
+	hash := sha1.New()
+	_, err = io.Copy(io.MultiWriter(tmp, hash), resp.Body)
+	if closeErr := tmp.Close(); err == nil {
+		err = closeErr
+	}
+	if err != nil {
+		os.Remove(tmp.Name())
+		return "", sum, "", err
+	}
+	copy(sum[:], hash.Sum(nil))
+	return tmp.Name(), sum, resp.Header.Get("ETag"), nil
+}
+
+// saveETag remembers the validator of the file now at jsonFilePath. Failing
+// to save it only costs a full download next time.
+func saveETag(jsonFilePath, etag string) {
+	if etag == "" {
+		os.Remove(etagPath(jsonFilePath))
+		return
+	}
+	os.WriteFile(etagPath(jsonFilePath), []byte(etag), 0o644)
 }
 
 func loadJSONData(jsonFilePath, owner, repo, path string, v interface{}, updateFlag bool) error {
 	if updateFlag {
 
 		// Notify we're checking for updates
-		fmt.Printf("Checking for PineCone updates..\n")
+		fmt.Fprintf(statusOut, "Checking for PineCone updates..\n")
 
-		// Download JSON data
-		jsonData, err := downloadJSONData(fmt.Sprintf("https://api.github.com/repos/%s/%s/contents/%s", owner, repo, path))
+		// Download JSON data, unless it has not changed since the last download
+		tmpPath, newHash, etag, err := downloadJSONData(fmt.Sprintf("https://api.github.com/repos/%s/%s/contents/%s", owner, repo, path), jsonFilePath)
 		if err != nil {
 			return err
 		}
+		if tmpPath == "" {
+			return decodeJSONFile(jsonFilePath, v)
+		}
 
 		// Check if downloaded JSON is different from existing JSON
 		if _, err := os.Stat(jsonFilePath); err == nil {
-			existingData, err := os.ReadFile(jsonFilePath)
+			existingHash, _, err := getSHA1Hash(context.Background(), os.DirFS(filepath.Dir(jsonFilePath)), filepath.Base(jsonFilePath))
 			if err != nil {
+				os.Remove(tmpPath)
 				return err
 			}
-			existingHash := fmt.Sprintf("%x", sha1.Sum(existingData))
-			newHash := fmt.Sprintf("%x", sha1.Sum(jsonData))
-			if existingHash == newHash {
-				return json.Unmarshal(existingData, &v)
+			if existingHash == hex.EncodeToString(newHash[:]) {
+				os.Remove(tmpPath)
+				saveETag(jsonFilePath, etag)
+				return decodeJSONFile(jsonFilePath, v)
 			}
 		}
+		return installJSONData(jsonFilePath, path, tmpPath, newHash, etag, v)
+	}
 
-		// Write the newly downloaded JSON to file
-		if guiEnabled {
-			addText(theme.ForegroundColor(), "Updating %s...", jsonFilePath)
-		} else {
-			fmt.Printf("Updating %s...\n", jsonFilePath)
-		}
-		err = os.WriteFile(jsonFilePath, jsonData, 0o644)
-		if err != nil {
-			return err
-		}
+	// Load existing JSON data
+	return decodeJSONFile(jsonFilePath, v)
+}
 
-		// Load the newly downloaded JSON data
-		if guiEnabled {
-			addText(theme.ForegroundColor(), "Reloading %s...", path)
-		} else {
-			fmt.Printf("Reloading %s...\n", path)
-		}
-		jsonStr := removeCommentsFromJSON(string(jsonData))
-		err = json.Unmarshal([]byte(jsonStr), &v)
-		if err != nil {
-			return err
-		}
+// installJSONData decodes the downloaded tmpPath into v, then moves it over
+// jsonFilePath and saves its ETag. A download that does not decode is
+// removed, leaving the existing file and ETag as they were.
+func installJSONData(jsonFilePath, path, tmpPath string, sum [sha1.Size]byte, etag string, v interface{}) error {
+	defer os.Remove(tmpPath) // fails once renamed
+
+	// Load the newly downloaded JSON data
+	if guiEnabled {
+		addText(theme.ForegroundColor(), "Reloading %s...", path)
 	} else {
-		// Load existing JSON data
-		jsonData, err := os.ReadFile(jsonFilePath)
-		if err != nil {
-			return err
-		}
-		jsonStr := removeCommentsFromJSON(string(jsonData))
-		err = json.Unmarshal([]byte(jsonStr), &v)
-		if err != nil {
-			return err
-		}
+		fmt.Fprintf(statusOut, "Reloading %s...\n", path)
+	}
+	file, err := os.Open(tmpPath)
+	if err != nil {
+		return err
+	}
+	fresh := reflect.New(reflect.TypeOf(v).Elem())
+	err = decodeJSON(jsonFilePath, sum, file, fresh.Interface())
+	file.Close()
+	if err != nil {
+		return fmt.Errorf("downloaded %s is not a valid database, keeping %s: %v", path, jsonFilePath, err)
 	}
 
+	// Move the newly downloaded JSON into place
+	if guiEnabled {
+		addText(theme.ForegroundColor(), "Updating %s...", jsonFilePath)
+	} else {
+		fmt.Fprintf(statusOut, "Updating %s...\n", jsonFilePath)
+	}
+	if err := os.Rename(tmpPath, jsonFilePath); err != nil {
+		return err
+	}
+	saveETag(jsonFilePath, etag)
+	reflect.ValueOf(v).Elem().Set(fresh.Elem())
 	return nil
 }
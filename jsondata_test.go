@@ -0,0 +1,61 @@
+package main
+
+import (
+	"crypto/sha1"
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// TestInstallJSONData checks that a download replaces the database and its
+// ETag only once it decodes.
+func TestInstallJSONData(t *testing.T) {
+	dir := t.TempDir()
+	jsonPath := filepath.Join(dir, "id_database.json")
+	old := []byte(`{"Titles": {"4d530004": {"Title Name": "Halo 2"}}}`)
+	if err := os.WriteFile(jsonPath, old, 0o644); err != nil {
+		t.Fatal(err)
+	}
+	saveETag(jsonPath, `"old"`)
+
+	download := func(body string) string {
+		path := filepath.Join(dir, "id_database.json.download.tmp")
+		if err := os.WriteFile(path, []byte(body), 0o644); err != nil {
+			t.Fatal(err)
+		}
+		return path
+	}
+	etag := func() string {
+		data, _ := os.ReadFile(etagPath(jsonPath))
+		return string(data)
+	}
+
+	for _, bad := range []string{`<html>rate limited</html>`, `{"Titles": []}`, `{"Titles": {`} {
+		tmp := download(bad)
+		var list TitleList
+		if err := installJSONData(jsonPath, "id_database.json", tmp, sha1.Sum([]byte(bad)), `"bad"`, &list); err == nil {
+			t.Errorf("installed %s", bad)
+		}
+		if data, _ := os.ReadFile(jsonPath); string(data) != string(old) {
+			t.Errorf("installing %s replaced the database", bad)
+		}
+		if etag() != `"old"` {
+			t.Errorf("installing %s saved the ETag %s", bad, etag())
+		}
+		if _, err := os.Stat(tmp); !os.IsNotExist(err) {
+			t.Errorf("installing %s left the download behind", bad)
+		}
+	}
+
+	good := `{"Titles": {"41560017": {"Title Name": "Project Gotham Racing 2"}}}`
+	var list TitleList
+	if err := installJSONData(jsonPath, "id_database.json", download(good), sha1.Sum([]byte(good)), `"new"`, &list); err != nil {
+		t.Fatal(err)
+	}
+	if list.Titles["41560017"].TitleName != "Project Gotham Racing 2" || list.index == nil {
+		t.Errorf("installed list = %+v", list.Titles)
+	}
+	if data, _ := os.ReadFile(jsonPath); string(data) != good || etag() != `"new"` {
+		t.Errorf("database %s with ETag %s after installing", data, etag())
+	}
+}
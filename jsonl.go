@@ -0,0 +1,125 @@
+package main
+
+import (
+	"encoding/json"
+	"io"
+	"sync"
+)
+
+// jsonlSink streams scan results as JSON Lines: one "finding" object per
+// piece of content, "error" objects for problems, and a closing "summary".
+type jsonlSink struct {
+	mu  sync.Mutex
+	enc *json.Encoder
+}
+
+type jsonlFinding struct {
+	Type string `json:"type"`
+	finding
+}
+
+type jsonlError struct {
+	Type    string `json:"type"`
+	Message string `json:"message"`
+}
+
+type jsonlSummary struct {
+	Type        string                `json:"type"`
+	TitleDirs   int                   `json:"titleDirs"`
+	XBEFiles    int                   `json:"xbeFiles,omitempty"`
+	Findings    map[findingStatus]int `json:"findings"`
+	CacheHits   int64                 `json:"cacheHits"`
+	CacheMisses int64                 `json:"cacheMisses"`
+	Duplicates  int64                 `json:"duplicates,omitempty"`
+	HashedBytes int64                 `json:"hashedBytes,omitempty"`
+	Unhashed    int                   `json:"unhashed,omitempty"`
+	Reused      int                   `json:"reused,omitempty"`
+	Exported    int64                 `json:"exportedFiles,omitempty"`
+	ExportBytes int64                 `json:"exportedBytes,omitempty"`
+	ExportSkip  int64                 `json:"exportSkipped,omitempty"`
+	ElapsedMs   float64               `json:"elapsedMs"`
+	Profile     *jsonlProfile         `json:"profile,omitempty"`
+}
+
+type jsonlProfile struct {
+	Listings  int64   `json:"dirListings"`
+	Stats     int64   `json:"stats"`
+	Opens     int64   `json:"opens"`
+	ListMs    float64 `json:"listMs"`
+	StatMs    float64 `json:"statMs"`
+	HashMs    float64 `json:"hashMs"`
+	GUIMs     float64 `json:"guiMs,omitempty"`
+	GUIFrames int64   `json:"guiFrames,omitempty"`
+}
+
+func newJSONLSink(w io.Writer) *jsonlSink {
+	return &jsonlSink{enc: json.NewEncoder(w)}
+}
+
+func (s *jsonlSink) emit(r *titleResult) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	for _, f := range r.findings {
+		s.enc.Encode(jsonlFinding{Type: "finding", finding: f})
+	}
+	for _, problem := range r.problems {
+		s.enc.Encode(jsonlError{Type: "error", Message: problem})
+	}
+	if r.err != nil {
+		s.enc.Encode(jsonlError{Type: "error", Message: r.err.Error()})
+	}
+	if st := r.summary; st != nil {
+		findings := make(map[findingStatus]int)
+		for status, n := range st.Findings {
+			findings[findingStatus(status)] = n
+		}
+		var profile *jsonlProfile
+		if ps := st.Profile; ps != nil {
+			profile = &jsonlProfile{
+				Listings:  ps.Listings,
+				Stats:     ps.Stats,
+				Opens:     ps.Opens,
+				ListMs:    float64(ps.ListTime.Microseconds()) / 1000,
+				StatMs:    float64(ps.StatTime.Microseconds()) / 1000,
+				HashMs:    float64(ps.HashTime.Microseconds()) / 1000,
+				GUIMs:     float64(ps.GUITime.Microseconds()) / 1000,
+				GUIFrames: ps.GUIFrames,
+			}
+		}
+		s.enc.Encode(jsonlSummary{
+			Type:        "summary",
+			TitleDirs:   st.TitleDirs,
+			XBEFiles:    st.XBEFiles,
+			Findings:    findings,
+			CacheHits:   st.CacheHits,
+			CacheMisses: st.CacheMisses,
+			Duplicates:  st.Duplicates,
+			HashedBytes: st.HashedBytes,
+			Unhashed:    st.Unhashed,
+			Reused:      st.Reused,
+			Exported:    st.ExportedFiles,
+			ExportBytes: st.ExportedBytes,
+			ExportSkip:  st.ExportSkipped,
+			ElapsedMs:   float64(st.Elapsed.Microseconds()) / 1000,
+			Profile:     profile,
+		})
+	}
+}
+
+// newCLISink returns the sink for console scans in the selected -format.
+func newCLISink(w io.Writer) scanSink {
+	if outputFormat == "jsonl" {
+		return newJSONLSink(w)
+	}
+	return consoleSink{}
+}
+
+// newReportSink returns the sink for scan reports written to w, and the file
+// extension for such reports, in the selected -format.
+func newReportSink(w io.Writer) (scanSink, string) {
+	if outputFormat == "jsonl" {
+		return newJSONLSink(w), ".jsonl"
+	}
+	return reportSink{w}, ".txt"
+}
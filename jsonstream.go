@@ -0,0 +1,196 @@
+package main
+
+import (
+	"encoding/json"
+	"fmt"
+	"io"
+	"strings"
+)
+
+// commentStripper is an io.Reader that removes // and /* */ comments from
+// the JSON read through it. It tracks string literals, so comment markers
+// inside strings (URLs, for instance) are left alone.
+type commentStripper struct {
+	r     io.Reader
+	in    []byte
+	out   []byte // filtered bytes not yet returned, backed by buf
+	buf   []byte
+	state int
+	err   error
+}
+
+const (
+	jsonCode = iota
+	jsonString
+	jsonEscape
+	jsonSlash // a '/' that may start a comment
+	jsonLineComment
+	jsonBlockComment
+	jsonBlockStar // a '*' that may end a block comment
+)
+
+func newCommentStripper(r io.Reader) *commentStripper {
+	const size = 64 << 10
+	return &commentStripper{r: r, in: make([]byte, size), buf: make([]byte, size+1)}
+}
+
+func (c *commentStripper) Read(p []byte) (int, error) {
+	for len(c.out) == 0 {
+		if c.err != nil {
+			if c.state == jsonSlash {
+				// A lone '/' at the very end is not a comment
+				c.state = jsonCode
+				c.out = append(c.buf[:0], '/')
+				break
+			}
+			return 0, c.err
+		}
+		n, err := c.r.Read(c.in)
+		c.err = err
+		c.out = c.buf[:c.filter(c.buf, c.in[:n])]
+	}
+
+	n := copy(p, c.out)
+	c.out = c.out[n:]
+	return n, nil
+}
+
+// filter copies src to dst without comments and returns the bytes written;
+// dst has room for len(src)+1 bytes.
+func (c *commentStripper) filter(dst, src []byte) int {
+	w := 0
+	for i := 0; i < len(src); i++ {
+		b := src[i]
+		switch c.state {
+		case jsonCode:
+			// Copy plain JSON up to the next quote or slash in one go
+			j := i
+			for j < len(src) && src[j] != '"' && src[j] != '/' {
+				j++
+			}
+			w += copy(dst[w:], src[i:j])
+			i = j
+			if j == len(src) {
+				break
+			}
+			if src[j] == '/' {
+				c.state = jsonSlash
+			} else {
+				dst[w] = '"'
+				w++
+				c.state = jsonString
+			}
+		case jsonString:
+			dst[w] = b
+			w++
+			if b == '\\' {
+				c.state = jsonEscape
+			} else if b == '"' {
+				c.state = jsonCode
+			}
+		case jsonEscape:
+			dst[w] = b
+			w++
+			c.state = jsonString
+		case jsonSlash:
+			switch b {
+			case '/':
+				c.state = jsonLineComment
+			case '*':
+				c.state = jsonBlockComment
+			default:
+				dst[w] = '/'
+				w++
+				c.state = jsonCode
+				i-- // look at b again as code
+			}
+		case jsonLineComment:
+			if b == '\n' {
+				dst[w] = '\n'
+				w++
+				c.state = jsonCode
+			}
+		case jsonBlockComment:
+			if b == '*' {
+				c.state = jsonBlockStar
+			}
+		case jsonBlockStar:
+			switch b {
+			case '/':
+				// Keep the tokens either side apart
+				dst[w] = ' '
+				w++
+				c.state = jsonCode
+			case '*':
+			default:
+				c.state = jsonBlockComment
+			}
+		}
+	}
+	return w
+}
+
+// decodeTitleList fills t from JSON read from r one title at a time, so
+// the decoder never buffers more than a single title's entry.
+func decodeTitleList(r io.Reader, t *TitleList) error {
+	dec := json.NewDecoder(r)
+	if err := expectDelim(dec, '{'); err != nil {
+		return err
+	}
+	for dec.More() {
+		key, err := dec.Token()
+		if err != nil {
+			return err
+		}
+		// encoding/json matches field names case-insensitively too
+		if name, _ := key.(string); !strings.EqualFold(name, "Titles") {
+			var skip json.RawMessage
+			if err := dec.Decode(&skip); err != nil {
+				return err
+			}
+			continue
+		}
+
+		tok, err := dec.Token()
+		if err != nil {
+			return err
+		}
+		if tok == nil {
+			t.Titles = nil
+			continue
+		}
+		if tok != json.Delim('{') {
+			return fmt.Errorf("Titles: expected an object, found %v", tok)
+		}
+		if t.Titles == nil {
+			t.Titles = make(map[string]TitleData)
+		}
+		for dec.More() {
+			tok, err := dec.Token()
+			if err != nil {
+				return err
+			}
+			titleID, _ := tok.(string)
+			var data TitleData
+			if err := dec.Decode(&data); err != nil {
+				return fmt.Errorf("title %s: %v", titleID, err)
+			}
+			t.Titles[titleID] = data
+		}
+		if err := expectDelim(dec, '}'); err != nil {
+			return err
+		}
+	}
+	return expectDelim(dec, '}')
+}
+
+func expectDelim(dec *json.Decoder, delim json.Delim) error {
+	tok, err := dec.Token()
+	if err != nil {
+		return err
+	}
+	if tok != delim {
+		return fmt.Errorf("expected %v, found %v", delim, tok)
+	}
+	return nil
+}
@@ -0,0 +1,125 @@
+package main
+
+import (
+	"bytes"
+	"encoding/json"
+	"io"
+	"os"
+	"reflect"
+	"strings"
+	"testing"
+	"testing/iotest"
+)
+
+func stripComments(t *testing.T, r io.Reader) string {
+	t.Helper()
+	out, err := io.ReadAll(newCommentStripper(r))
+	if err != nil {
+		t.Fatal(err)
+	}
+	return string(out)
+}
+
+func TestCommentStripper(t *testing.T) {
+	tests := []struct{ in, want string }{
+		{`{"a": 1}`, `{"a": 1}`},
+		{"{\"a\": 1} // trailing\n", "{\"a\": 1} \n"},
+		{"// first\n{\"a\": 1}", "\n{\"a\": 1}"},
+		{`{"url": "https://example.com/a//b"}`, `{"url": "https://example.com/a//b"}`},
+		{`{"s": "/* not a comment */"}`, `{"s": "/* not a comment */"}`},
+		{`{"s": "quote \" // still a string"}`, `{"s": "quote \" // still a string"}`},
+		{`{"s": "backslash \\"// comment` + "\n}", `{"s": "backslash \\"` + "\n}"},
+		{`[1/* block */2]`, `[1 2]`},
+		{`[1/** stars **/, 2]`, `[1 , 2]`},
+		{"[1, /* multi\nline */ 2]", "[1,   2]"},
+		{`[1] / 2`, `[1] / 2`},
+		{`[1]/`, `[1]/`},
+		{`[1] /* unterminated`, `[1] `},
+	}
+	for _, test := range tests {
+		if got := stripComments(t, strings.NewReader(test.in)); got != test.want {
+			t.Errorf("strip(%q) = %q, want %q", test.in, got, test.want)
+		}
+		// Every state must survive a read boundary
+		if got := stripComments(t, iotest.OneByteReader(strings.NewReader(test.in))); got != test.want {
+			t.Errorf("strip(%q) one byte at a time = %q, want %q", test.in, got, test.want)
+		}
+	}
+}
+
+func TestCommentStripperLargeInput(t *testing.T) {
+	// Comments and strings straddling the 64 KiB buffer
+	var in, want bytes.Buffer
+	in.WriteString("[")
+	want.WriteString("[")
+	for i := 0; in.Len() < 200<<10; i++ {
+		item := `"a // b /* c */", /* comment */ 1, // line` + "\n"
+		in.WriteString(item)
+		want.WriteString(`"a // b /* c */",   1, ` + "\n")
+	}
+	in.WriteString("2]")
+	want.WriteString("2]")
+	if got := stripComments(t, bytes.NewReader(in.Bytes())); got != want.String() {
+		t.Errorf("stripping %d bytes differs from the expected output", in.Len())
+	}
+}
+
+func TestDecodeTitleList(t *testing.T) {
+	in := `{
+		"Version": {"skipped": [1, 2]},
+		"titles": {
+			"4d530004": {"Title Name": "Halo 2", "Content IDs": ["4d53000400000001"]},
+			"41560017": {"Title Name": "Project Gotham Racing 2"}
+		},
+		"Extra": null
+	}`
+	var got TitleList
+	if err := decodeTitleList(strings.NewReader(in), &got); err != nil {
+		t.Fatal(err)
+	}
+	want := map[string]TitleData{
+		"4d530004": {TitleName: "Halo 2", ContentIDs: []string{"4d53000400000001"}},
+		"41560017": {TitleName: "Project Gotham Racing 2"},
+	}
+	if !reflect.DeepEqual(got.Titles, want) {
+		t.Errorf("titles = %+v, want %+v", got.Titles, want)
+	}
+
+	var null TitleList
+	if err := decodeTitleList(strings.NewReader(`{"Titles": null}`), &null); err != nil || null.Titles != nil {
+		t.Errorf("null titles = %v, %v", null.Titles, err)
+	}
+
+	for _, bad := range []string{
+		`[]`,
+		`{"Titles": []}`,
+		`{"Titles": {"4d530004": {"Content IDs": "not a list"}}}`,
+		`{"Titles": {"4d530004": {}}`,
+	} {
+		var list TitleList
+		if err := decodeTitleList(strings.NewReader(bad), &list); err == nil {
+			t.Errorf("decoding %s succeeded", bad)
+		}
+	}
+}
+
+// TestDecodeTitleListDatabase checks the streaming decoder against
+// encoding/json on the database itself.
+func TestDecodeTitleListDatabase(t *testing.T) {
+	file, err := os.Open(testJSONPath)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer file.Close()
+	data := []byte(stripComments(t, file))
+	var got, want TitleList
+	if err := decodeTitleList(bytes.NewReader(data), &got); err != nil {
+		t.Fatal(err)
+	}
+	if err := json.Unmarshal(data, &want); err != nil {
+		t.Fatal(err)
+	}
+	if len(got.Titles) == 0 || !reflect.DeepEqual(got.Titles, want.Titles) {
+		t.Errorf("decoded %d titles, encoding/json %d, or they differ", len(got.Titles), len(want.Titles))
+	}
+}
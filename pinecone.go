@@ -3,19 +3,46 @@ package main
 import (
 	"flag"
 	"fmt"
+	"io"
+	"os"
+	"runtime"
+	"time"
 )
 
 var (
-	titles        TitleList
-	updateFlag    = false
-	summarizeFlag = false
-	titleIDFlag   = ""
-	fatxplorer    = false
-	dumpLocation  = "dump"
-	helpFlag      = false
-	version       = "0.6.0"
-	guiEnabled    = true
-	dataPath      = "data"
+	updateFlag      = false
+	summarizeFlag   = false
+	titleIDFlag     = ""
+	fatxplorer      = false
+	dumpLocation    = "dump"
+	helpFlag        = false
+	version         = "0.6.0"
+	guiEnabled      = true
+	dataPath        = "data"
+	scanWorkers     = runtime.NumCPU()
+	noHashCache     = false
+	batchList       = ""
+	batchManifest   = ""
+	batchJobs       = 2
+	outputFormat    = "text"
+	fatxPartition   = "E"
+	incrementalScan = false
+	hashJobs        = 2
+	hashUnknown     = false
+	profileDir      = ""
+	scanRootsFlag   = "TDATA"
+	selectedRoots   = []string{"TDATA"}
+	scanTimeout     time.Duration
+	watchMode       = false
+	serveAddr       = ""
+	exportDir       = ""
+	fingerprintDLC  = false
+	resultsPath     = ""
+	diffFlag        = ""
+
+	// statusOut receives progress and banner messages, keeping stdout clean
+	// for machine-readable output formats.
+	statusOut io.Writer = os.Stdout
 )
 
 func main() {
@@ -33,6 +60,26 @@ func main() {
 	flag.BoolVar(&helpFlag, "h", false, "Display help information")
 	flag.BoolVar(&guiEnabled, "gui", true, "Enable GUI")
 	flag.BoolVar(&guiEnabled, "g", true, "Enable GUI")
+	flag.IntVar(&scanWorkers, "workers", runtime.NumCPU(), "Number of title directories to scan in parallel")
+	flag.IntVar(&scanWorkers, "w", runtime.NumCPU(), "Number of title directories to scan in parallel")
+	flag.IntVar(&hashJobs, "hashjobs", 2, "Number of files hashed at the same time per disk")
+	flag.BoolVar(&hashUnknown, "hashunknown", false, "Hash title updates even when their size matches no known update")
+	flag.BoolVar(&noHashCache, "nocache", false, "Do not use the SHA1 hash cache")
+	flag.StringVar(&batchList, "batch", "", "Comma separated list of dump roots to scan in one run")
+	flag.StringVar(&batchManifest, "manifest", "", "File listing dump roots to scan in one run, one per line")
+	flag.IntVar(&batchJobs, "batchjobs", 2, "Number of dump roots scanned at the same time in batch mode")
+	flag.StringVar(&outputFormat, "format", "text", "Output format for CLI scans: text or jsonl")
+	flag.StringVar(&fatxPartition, "partition", "E", "Partition to scan when the location is a raw drive image")
+	flag.StringVar(&scanRootsFlag, "roots", "TDATA", "Comma separated dump folders to scan: TDATA, UDATA, C, E, F, G or all")
+	flag.StringVar(&profileDir, "profile", "", "Write CPU, heap and trace profiles to this directory and report per-phase scan timings")
+	flag.BoolVar(&incrementalScan, "incremental", false, "Reuse results for title directories unchanged since the last scan")
+	flag.StringVar(&exportDir, "export", "", "Copy unarchived and unknown content found by scans into a deduplicating store in this directory")
+	flag.BoolVar(&fingerprintDLC, "fingerprint", false, "Hash every file of each DLC folder and check it against the database's content fingerprints")
+	flag.StringVar(&resultsPath, "results", "", "Save the findings of the scan to this results file (.pcscan) for -diff")
+	flag.StringVar(&diffFlag, "diff", "", "Compare two saved scans: -diff=old.pcscan,new.pcscan")
+	flag.StringVar(&serveAddr, "serve", "", "Serve classification queries and scans over HTTP on this address (e.g. 127.0.0.1:7717)")
+	flag.BoolVar(&watchMode, "watch", false, "Keep watching the dump and scan title directories as they appear or change")
+	flag.DurationVar(&scanTimeout, "timeout", 0, "Stop scans that take longer than this (e.g. 10m)")
 
 	flag.Parse() // Parse command line flags
 
@@ -43,12 +90,61 @@ func main() {
 		fmt.Println("  -s, --summarize:  Print summary statistics for all titles. If not set, checks for content in the TDATA folder.")
 		fmt.Println("  -tID, --titleid:  Filter statistics by Title ID (-titleID=ABCD1234). If not set, statistics are computed for all titles.")
 		fmt.Println("  -f, --fatxplorer: Use FATXPlorer's X drive as the root directory. If not set, runs as normal. (Windows Only)")
-		fmt.Println("  -l --location:    Directory where TDATA/UDATA folders are stored. If not set, checks in \"dump\"")
+		fmt.Println("  -l --location:    Directory where TDATA/UDATA folders are stored, a zip of a dump, or a raw FATX drive/partition image or block device. If not set, checks in \"dump\"")
+		fmt.Println("  -partition:       Partition to scan when the location is a full drive image (C, E, F, X, Y, Z; default = E)")
 		fmt.Println("  -g, --gui:        Enable the GUI interface (default = true)")
+		fmt.Println("  -w, --workers:    Number of title directories scanned in parallel (-workers=4). If not set, uses one per CPU.")
+		fmt.Println("  -hashjobs:        Number of files hashed at the same time on each disk (default = 2). Use 1 for spinning drives.")
+		fmt.Println("  -hashunknown:     Hash every title update, even those whose size already rules out all known updates (for archival submissions).")
+		fmt.Println("  -nocache:         Hash every title update again instead of using data/hash_cache.json.")
+		fmt.Println("  -roots:           Dump folders to scan in one pass (-roots=TDATA,E or -roots=all for TDATA, UDATA, C, E, F and G; default = TDATA)")
+		fmt.Println("  -incremental:     Only rescan title directories that changed since the last scan, reusing data/scan_snapshot.json for the rest.")
+		fmt.Println("  -fingerprint:     Hash every file of each DLC folder into a content fingerprint, flagging known content whose files differ from the \"Content Fingerprints\" recorded in the database as modified.")
+		fmt.Println("  -export:          Copy unarchived and unknown DLC and unknown title updates into the given store folder, each unique file once (objects/ named by SHA1, items/ manifests).")
+		fmt.Println("  -results:         Save the findings of the scan to the given results file (-results=drive1.pcscan). Batch runs and the GUI's Save Output write one next to each report.")
+		fmt.Println("  -diff:            Report new, removed and changed findings between two saved scans (-diff=old.pcscan,new.pcscan) and exit. Implies -gui=false.")
+		fmt.Println("  -serve:           Keep the database and hash cache loaded and answer queries and scans over HTTP on the given address (-serve=127.0.0.1:7717). Implies -gui=false.")
+		fmt.Println("  -watch:           Scan the dump, then keep watching it (or FatXplorer's X: drive with -f) and scan title directories as they appear or change, until stopped.")
+		fmt.Println("  -timeout:         Stop a scan that runs longer than the given duration (-timeout=10m), printing the summary of what was scanned. Applies to each dump in batch mode.")
+		fmt.Println("  -batch:           Scan several dumps in one run (-batch=drive1,drive2). Implies -gui=false.")
+		fmt.Println("  -manifest:        File listing dumps to scan in one run, one per line. Implies -gui=false.")
+		fmt.Println("  -batchjobs:       Number of dumps scanned at the same time in batch mode (default = 2)")
+		fmt.Println("  -format:          Output format for CLI scans and batch reports: text (default) or jsonl (one JSON object per finding).")
+		fmt.Println("  -profile:         Write cpu.pprof, heap.pprof and trace.out to the given directory and add per-phase timings and filesystem call counts to the scan summary.")
 		fmt.Println("  -h, --help:       Display this help information.")
 		return
 	}
 
+	switch outputFormat {
+	case "text":
+	case "jsonl":
+		statusOut = os.Stderr
+	default:
+		fmt.Printf("Unknown output format %q, expected text or jsonl\n", outputFormat)
+		return
+	}
+
+	roots, err := parseScanRoots(scanRootsFlag)
+	if err != nil {
+		fmt.Println(err)
+		return
+	}
+	selectedRoots = roots
+
+	if profileDir != "" {
+		stop, err := startProfiling(profileDir)
+		if err != nil {
+			fmt.Println(err)
+			return
+		}
+		defer stop()
+	}
+
+	// Batch runs, the server and -diff are headless
+	if batchList != "" || batchManifest != "" || serveAddr != "" || diffFlag != "" {
+		guiEnabled = false
+	}
+
 	jsonFilePath := "data/id_database.json"
 	jsonDataFolder := "data"
 	jsonURL := "https://api.github.com/repos/MrMilenko/Pinecone/contents/data/id_database.json"
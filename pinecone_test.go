@@ -0,0 +1,52 @@
+package main
+
+import (
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// testDir is a temporary folder removed after the run. testJSONPath is a
+// copy of data/id_database.json in a data folder inside it, loaded before
+// the tests run, so tests never touch the real data/.
+var (
+	testDir      string
+	testJSONPath string
+)
+
+func TestMain(m *testing.M) {
+	os.Exit(runTests(m))
+}
+
+func runTests(m *testing.M) int {
+	dir, err := os.MkdirTemp("", "pinecone-test-")
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		return 1
+	}
+	defer os.RemoveAll(dir)
+	testDir = dir
+
+	guiEnabled = false
+	statusOut = io.Discard
+	dataPath = filepath.Join(dir, "data")
+	testJSONPath = filepath.Join(dataPath, "id_database.json")
+
+	data, err := os.ReadFile(filepath.Join("data", "id_database.json"))
+	if err == nil {
+		err = os.MkdirAll(dataPath, 0o755)
+	}
+	if err == nil {
+		err = os.WriteFile(testJSONPath, data, 0o644)
+	}
+	if err == nil {
+		err = loadTitleDatabase(testJSONPath, "", false)
+	}
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		return 1
+	}
+	return m.Run()
+}
@@ -0,0 +1,172 @@
+package main
+
+import (
+	"fmt"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"runtime"
+	"runtime/pprof"
+	"runtime/trace"
+	"sync/atomic"
+	"time"
+)
+
+// startProfiling writes a CPU profile and an execution trace of the whole
+// run to dir; the returned function stops them and adds a heap profile.
+func startProfiling(dir string) (func(), error) {
+	if err := os.MkdirAll(dir, 0o755); err != nil {
+		return nil, err
+	}
+	cpuFile, err := os.Create(filepath.Join(dir, "cpu.pprof"))
+	if err != nil {
+		return nil, err
+	}
+	if err := pprof.StartCPUProfile(cpuFile); err != nil {
+		cpuFile.Close()
+		return nil, err
+	}
+	traceFile, err := os.Create(filepath.Join(dir, "trace.out"))
+	if err != nil {
+		pprof.StopCPUProfile()
+		cpuFile.Close()
+		return nil, err
+	}
+	if err := trace.Start(traceFile); err != nil {
+		pprof.StopCPUProfile()
+		cpuFile.Close()
+		traceFile.Close()
+		return nil, err
+	}
+
+	return func() {
+		trace.Stop()
+		traceFile.Close()
+		pprof.StopCPUProfile()
+		cpuFile.Close()
+
+		heapFile, err := os.Create(filepath.Join(dir, "heap.pprof"))
+		if err != nil {
+			fmt.Fprintf(statusOut, "Could not write heap profile: %v\n", err)
+			return
+		}
+		defer heapFile.Close()
+		runtime.GC()
+		if err := pprof.WriteHeapProfile(heapFile); err != nil {
+			fmt.Fprintf(statusOut, "Could not write heap profile: %v\n", err)
+		}
+	}, nil
+}
+
+// guiRenderTime and guiFrames count the time renderOutput spends applying
+// queued lines and refreshing the output list.
+var (
+	guiRenderTime atomic.Int64
+	guiFrames     atomic.Int64
+)
+
+// scanProfile counts the filesystem calls of one scan pass and the time
+// spent in each phase. Phase times are summed over all workers, so they can
+// add up to more than the scan time.
+type scanProfile struct {
+	listings atomic.Int64
+	stats    atomic.Int64
+	opens    atomic.Int64
+	listTime atomic.Int64
+	statTime atomic.Int64
+	hashTime atomic.Int64
+
+	guiTimeStart   int64
+	guiFramesStart int64
+}
+
+// profileStats is the scanProfile of a finished pass, for the summary.
+type profileStats struct {
+	Listings  int64
+	Stats     int64
+	Opens     int64
+	ListTime  time.Duration
+	StatTime  time.Duration
+	HashTime  time.Duration
+	GUITime   time.Duration
+	GUIFrames int64
+}
+
+func newScanProfile() *scanProfile {
+	return &scanProfile{
+		guiTimeStart:   guiRenderTime.Load(),
+		guiFramesStart: guiFrames.Load(),
+	}
+}
+
+func (p *scanProfile) snapshot() *profileStats {
+	return &profileStats{
+		Listings:  p.listings.Load(),
+		Stats:     p.stats.Load(),
+		Opens:     p.opens.Load(),
+		ListTime:  time.Duration(p.listTime.Load()),
+		StatTime:  time.Duration(p.statTime.Load()),
+		HashTime:  time.Duration(p.hashTime.Load()),
+		GUITime:   time.Duration(guiRenderTime.Load() - p.guiTimeStart),
+		GUIFrames: guiFrames.Load() - p.guiFramesStart,
+	}
+}
+
+// profiledFS wraps the fs.FS of a scan, counting and timing every directory
+// listing, stat and open that goes through it.
+type profiledFS struct {
+	fsys fs.FS
+	p    *scanProfile
+}
+
+func (f profiledFS) Open(name string) (fs.File, error) {
+	f.p.opens.Add(1)
+	return f.fsys.Open(name)
+}
+
+func (f profiledFS) Stat(name string) (fs.FileInfo, error) {
+	started := time.Now()
+	info, err := fs.Stat(f.fsys, name)
+	f.p.stats.Add(1)
+	f.p.statTime.Add(int64(time.Since(started)))
+	return info, err
+}
+
+func (f profiledFS) ReadDir(name string) ([]fs.DirEntry, error) {
+	started := time.Now()
+	entries, err := fs.ReadDir(f.fsys, name)
+	f.p.listings.Add(1)
+	f.p.listTime.Add(int64(time.Since(started)))
+	for i, entry := range entries {
+		entries[i] = profiledEntry{entry, f.p}
+	}
+	return entries, err
+}
+
+// profiledEntry counts DirEntry.Info, which is a stat on most filesystems.
+type profiledEntry struct {
+	fs.DirEntry
+	p *scanProfile
+}
+
+func (e profiledEntry) Info() (fs.FileInfo, error) {
+	started := time.Now()
+	info, err := e.DirEntry.Info()
+	e.p.stats.Add(1)
+	e.p.statTime.Add(int64(time.Since(started)))
+	return info, err
+}
+
+// addTo appends the profile to a scan summary, which already holds the
+// findings per status and the scan time.
+func (ps *profileStats) addTo(r *titleResult, st scanStats) {
+	r.addHeader("Scan Profile")
+	r.addInfo(levelInfo, "Directory listings: %d (%s)", ps.Listings, ps.ListTime.Round(time.Microsecond))
+	r.addInfo(levelInfo, "Stats: %d (%s)", ps.Stats, ps.StatTime.Round(time.Microsecond))
+	r.addInfo(levelInfo, "Files opened: %d", ps.Opens)
+	r.addInfo(levelInfo, "Hashing: %.1f MB (%s)", float64(st.HashedBytes)/(1<<20), ps.HashTime.Round(time.Microsecond))
+	if guiEnabled {
+		r.addInfo(levelInfo, "GUI refresh: %d frames (%s)", ps.GUIFrames, ps.GUITime.Round(time.Microsecond))
+	}
+	r.addInfo(levelInfo, "Phase times are summed over all workers (-workers=%d)", scanWorkers)
+}
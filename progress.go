@@ -0,0 +1,162 @@
+package main
+
+import (
+	"context"
+	"fmt"
+	"os"
+	"strings"
+	"sync"
+	"time"
+)
+
+// progressInterval is how often a running scan reports its progress.
+const progressInterval = 250 * time.Millisecond
+
+// scanProgress is a snapshot of a running scan.
+type scanProgress struct {
+	Done        int64 // title directories and files scanned
+	Expected    int64 // found so far; grows while the walk runs ahead
+	HashedBytes int64
+	Elapsed     time.Duration
+	Remaining   time.Duration // estimate, 0 while unknown
+	Finished    bool
+}
+
+func (s *scanPass) progress() scanProgress {
+	p := scanProgress{
+		Done:        s.completed.Load(),
+		Expected:    s.expected.Load(),
+		HashedBytes: s.hashedBytes.Load(),
+		Elapsed:     time.Since(s.start),
+	}
+	if p.Done > 0 && p.Expected > p.Done {
+		p.Remaining = time.Duration(float64(p.Elapsed) * float64(p.Expected-p.Done) / float64(p.Done))
+	}
+	return p
+}
+
+// reportProgress sends a snapshot to progress every progressInterval until
+// done is closed. Snapshots the receiver is not ready for are dropped.
+func (s *scanPass) reportProgress(progress chan<- scanProgress, done <-chan struct{}) {
+	ticker := time.NewTicker(progressInterval)
+	defer ticker.Stop()
+	for {
+		select {
+		case <-ticker.C:
+			select {
+			case progress <- s.progress():
+			default:
+			}
+		case <-done:
+			return
+		}
+	}
+}
+
+// fraction is how far along the scan is, between 0 and 1.
+func (p scanProgress) fraction() float64 {
+	if p.Finished {
+		return 1
+	}
+	if p.Expected == 0 {
+		return 0
+	}
+	return float64(p.Done) / float64(p.Expected)
+}
+
+func (p scanProgress) String() string {
+	if p.Finished {
+		return fmt.Sprintf("Scanned %d of %d in %s", p.Done, p.Expected, p.Elapsed.Round(time.Millisecond))
+	}
+	text := fmt.Sprintf("Scanned %d of %d, %.1f MB hashed", p.Done, p.Expected, float64(p.HashedBytes)/(1<<20))
+	if p.Remaining > 0 {
+		text += fmt.Sprintf(", about %s left", p.Remaining.Round(time.Second))
+	}
+	return text
+}
+
+// statusLine keeps the progress of a CLI scan on the last line of a
+// terminal. Results printed through statusSink clear it first; it is drawn
+// again on the next update.
+type statusLine struct {
+	mu    sync.Mutex
+	w     *os.File
+	width int // of the line on screen, 0 if there is none
+}
+
+func (l *statusLine) show(text string) {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	l.clearLocked()
+	fmt.Fprint(l.w, text)
+	l.width = len(text)
+}
+
+func (l *statusLine) clear() {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	l.clearLocked()
+}
+
+func (l *statusLine) clearLocked() {
+	if l.width > 0 {
+		fmt.Fprintf(l.w, "\r%s\r", strings.Repeat(" ", l.width))
+		l.width = 0
+	}
+}
+
+// statusSink clears the status line before each result is printed.
+type statusSink struct {
+	scanSink
+	line *statusLine
+}
+
+func (s statusSink) emit(r *titleResult) {
+	s.line.mu.Lock()
+	defer s.line.mu.Unlock()
+	s.line.clearLocked()
+	s.scanSink.emit(r)
+}
+
+func isTerminal(f *os.File) bool {
+	info, err := f.Stat()
+	return err == nil && info.Mode()&os.ModeCharDevice != 0
+}
+
+// runScan scans roots of src for the CLI or the GUI, showing progress on the
+// GUI progress bar or, when stderr is a terminal, on a status line. The
+// findings are saved as described at recordResults.
+func runScan(ctx context.Context, src *dumpSource, roots []scanRoot) error {
+	sink, saveResults := recordResults(src, roots, newCLISink(os.Stdout))
+	var show func(scanProgress)
+	switch {
+	case guiEnabled:
+		show = guiShowProgress
+	case isTerminal(os.Stderr):
+		line := &statusLine{w: os.Stderr}
+		sink = statusSink{sink, line}
+		show = func(p scanProgress) {
+			if p.Finished {
+				line.clear()
+			} else {
+				line.show(p.String())
+			}
+		}
+	default:
+		_, err := checkForContent(ctx, src, roots, sink, nil)
+		return saveResults(err)
+	}
+
+	progress := make(chan scanProgress, 1)
+	shown := make(chan struct{})
+	go func() {
+		defer close(shown)
+		for p := range progress {
+			show(p)
+		}
+	}()
+	_, err := checkForContent(ctx, src, roots, sink, progress)
+	close(progress)
+	<-shown
+	return saveResults(err)
+}
@@ -0,0 +1,229 @@
+package main
+
+import (
+	"encoding/binary"
+	"encoding/hex"
+	"encoding/json"
+	"hash/fnv"
+	"io/fs"
+	"os"
+	"path"
+	"path/filepath"
+	"sync"
+	"time"
+)
+
+const rescanSnapshotFileName = "scan_snapshot.json"
+
+// rescanLine is the saved form of an outputLine.
+type rescanLine struct {
+	Header bool        `json:"header,omitempty"`
+	Level  outputLevel `json:"level"`
+	Text   string      `json:"text"`
+}
+
+// rescanTitle is the saved result of one title directory, together with the
+// fingerprint of the directory it was produced from.
+type rescanTitle struct {
+	Fingerprint uint64       `json:"fingerprint"`
+	Lines       []rescanLine `json:"lines"`
+	Findings    []finding    `json:"findings,omitempty"`
+	Problems    []string     `json:"problems,omitempty"`
+}
+
+// rescanRoot holds the saved results of the last complete scan of one
+// TDATA directory. Database is the SHA1 of the title database the results
+// were produced with; any database change invalidates all of them, as does
+// switching -fingerprint or -hashunknown on or off or exporting to a
+// different store, since a reused result hashes and copies nothing.
+type rescanRoot struct {
+	Database      string                 `json:"database"`
+	Fingerprinted bool                   `json:"fingerprinted,omitempty"`
+	HashUnknown   bool                   `json:"hashUnknown,omitempty"`
+	Export        string                 `json:"export,omitempty"`
+	Titles        map[string]rescanTitle `json:"titles"`
+}
+
+// rescanOptions returns the part of a rescanRoot that depends on the
+// command line rather than on the database.
+func rescanOptions() rescanRoot {
+	export := exportDir
+	if export != "" {
+		if abs, err := filepath.Abs(export); err == nil {
+			export = abs
+		}
+	}
+	return rescanRoot{Fingerprinted: fingerprintDLC, HashUnknown: hashUnknown, Export: export}
+}
+
+// rescanSnapshot is the persisted state of incremental scans, keyed by the
+// scanned directory (see dumpSource.cacheKey).
+type rescanSnapshot struct {
+	mu    sync.Mutex
+	path  string
+	roots map[string]*rescanRoot
+}
+
+var (
+	sharedRescanSnapshot     *rescanSnapshot
+	sharedRescanSnapshotOnce sync.Once
+)
+
+// openRescanSnapshot returns the process-wide snapshot, loading it from the
+// data folder on first use. A missing or unreadable snapshot just means
+// every title directory is scanned again.
+func openRescanSnapshot() *rescanSnapshot {
+	sharedRescanSnapshotOnce.Do(func() {
+		s := &rescanSnapshot{
+			path:  filepath.Join(dataPath, rescanSnapshotFileName),
+			roots: make(map[string]*rescanRoot),
+		}
+		if data, err := os.ReadFile(s.path); err == nil {
+			if json.Unmarshal(data, &s.roots) != nil {
+				s.roots = make(map[string]*rescanRoot)
+			}
+		}
+		sharedRescanSnapshot = s
+	})
+	return sharedRescanSnapshot
+}
+
+// previous returns the saved results for key, or nil if there are none that
+// match the title database db and the current options.
+func (s *rescanSnapshot) previous(key string, db *TitleList) map[string]rescanTitle {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	root, ok := s.roots[key]
+	if !ok || root.Database != hex.EncodeToString(db.digest[:]) {
+		return nil
+	}
+	opts := rescanOptions()
+	if root.Fingerprinted != opts.Fingerprinted || root.HashUnknown != opts.HashUnknown || root.Export != opts.Export {
+		return nil
+	}
+	return root.Titles
+}
+
+// replace stores the results of a complete scan of key against db and
+// writes the snapshot back to disk.
+func (s *rescanSnapshot) replace(key string, db *TitleList, results map[string]rescanTitle) error {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	root := rescanOptions()
+	root.Database = hex.EncodeToString(db.digest[:])
+	root.Titles = results
+	s.roots[key] = &root
+	data, err := json.Marshal(s.roots)
+	if err != nil {
+		return err
+	}
+	tmpPath := s.path + ".tmp"
+	if err := os.WriteFile(tmpPath, data, 0o644); err != nil {
+		return err
+	}
+	return os.Rename(tmpPath, s.path)
+}
+
+func newRescanTitle(fingerprint uint64, r *titleResult) rescanTitle {
+	saved := rescanTitle{
+		Fingerprint: fingerprint,
+		Lines:       make([]rescanLine, len(r.lines)),
+		Findings:    r.findings,
+		Problems:    r.problems,
+	}
+	for i, line := range r.lines {
+		saved.Lines[i] = rescanLine{Header: line.header, Level: line.level, Text: line.text}
+	}
+	return saved
+}
+
+// result rebuilds the titleResult, stamping the findings with the time they
+// were reported in this scan.
+func (saved rescanTitle) result(elapsed time.Duration) *titleResult {
+	r := &titleResult{
+		lines:    make([]outputLine, len(saved.Lines)),
+		findings: make([]finding, len(saved.Findings)),
+		problems: saved.Problems,
+	}
+	for i, line := range saved.Lines {
+		r.lines[i] = outputLine{header: line.Header, level: line.Level, text: line.Text}
+	}
+	for i, f := range saved.Findings {
+		f.ElapsedMs = float64(elapsed.Microseconds()) / 1000
+		r.findings[i] = f
+	}
+	return r
+}
+
+// titleFingerprint summarises everything processTitleDir looks at: the
+// title directory itself and the entries of its $c and $u subdirectories,
+// found the way processTitleDir finds them.
+// Adding or removing content, touching a content folder or replacing a
+// title update all change it. With -fingerprint every file inside the
+// content folders counts as well.
+func titleFingerprint(fsys fs.FS, dir string) (uint64, error) {
+	h := fnv.New64a()
+	var buf [8]byte
+	writeInfo := func(name string, info fs.FileInfo) {
+		h.Write([]byte(name))
+		if info.IsDir() {
+			h.Write([]byte{'/'})
+		}
+		binary.LittleEndian.PutUint64(buf[:], uint64(info.Size()))
+		h.Write(buf[:])
+		binary.LittleEndian.PutUint64(buf[:], uint64(info.ModTime().UnixNano()))
+		h.Write(buf[:])
+	}
+
+	info, err := fs.Stat(fsys, dir)
+	if err != nil {
+		return 0, err
+	}
+	writeInfo(".", info)
+	entries, err := fs.ReadDir(fsys, dir)
+	if err != nil {
+		return 0, err
+	}
+	dlc, updates := titleSubDirs(dir, entries)
+
+	for _, subDir := range []string{dlc, updates} {
+		if subDir == "" {
+			h.Write([]byte{0})
+			continue
+		}
+		info, err := fs.Stat(fsys, subDir)
+		if err != nil {
+			return 0, err
+		}
+		writeInfo(path.Base(subDir), info)
+		entries, err := fs.ReadDir(fsys, subDir)
+		if err != nil {
+			return 0, err
+		}
+		for _, entry := range entries {
+			info, err := entry.Info()
+			if err != nil {
+				return 0, err
+			}
+			writeInfo(entry.Name(), info)
+			if fingerprintDLC && subDir == dlc && entry.IsDir() {
+				err := fs.WalkDir(fsys, path.Join(subDir, entry.Name()), func(name string, d fs.DirEntry, err error) error {
+					if err != nil {
+						return err
+					}
+					info, err := d.Info()
+					if err == nil {
+						writeInfo(name, info)
+					}
+					return err
+				})
+				if err != nil {
+					return 0, err
+				}
+			}
+		}
+	}
+	return h.Sum64(), nil
+}
@@ -0,0 +1,38 @@
+package main
+
+import (
+	"io/fs"
+	"testing"
+	"testing/fstest"
+	"time"
+)
+
+// TestTitleFingerprintCase checks that the fingerprint covers $c and $u in
+// whatever case the scanner found them.
+func TestTitleFingerprintCase(t *testing.T) {
+	for _, names := range [][2]string{{"$c", "$u"}, {"$C", "$U"}} {
+		dlc, updates := "4d530004/"+names[0], "4d530004/"+names[1]
+		fsys := fstest.MapFS{
+			dlc + "/4d53000400000001/contentmeta.xbx": {Data: []byte("meta")},
+			updates + "/default.xbe":                  {Data: []byte("v1")},
+		}
+		before, err := titleFingerprint(fsys, "4d530004")
+		if err != nil {
+			t.Fatal(err)
+		}
+
+		fsys[dlc+"/4d53000400000002"] = &fstest.MapFile{Mode: fs.ModeDir | 0o755}
+		added, err := titleFingerprint(fsys, "4d530004")
+		if err != nil {
+			t.Fatal(err)
+		}
+		if added == before {
+			t.Errorf("%s: adding content kept the fingerprint", names[0])
+		}
+
+		fsys[updates+"/default.xbe"] = &fstest.MapFile{Data: []byte("v2"), ModTime: time.Unix(1100000000, 0)}
+		if replaced, err := titleFingerprint(fsys, "4d530004"); err != nil || replaced == added {
+			t.Errorf("%s: replacing the update kept the fingerprint (%v)", names[1], err)
+		}
+	}
+}
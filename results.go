@@ -0,0 +1,534 @@
+package main
+
+import (
+	"bufio"
+	"crypto/sha1"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+	"time"
+)
+
+// A results file (.pcscan) is the compact saved form of one scan's findings,
+// for comparing scans with -diff. Findings are grouped by root and title ID;
+// each group is a run of records sorted by key, and an index at the front
+// holds every group's offset, length and SHA1. Comparing two files reads
+// both indexes and then only the groups whose SHA1s differ.
+//
+// Layout: magic, uvarint version, uvarint index length, then the index
+// (dump, scan time, database SHA1, uvarint group count and the groups
+// sorted by key) and the groups. Strings are encoded as in snapshot.go.
+
+const (
+	resultsMagic   = "PCSR"
+	resultsVersion = 1
+	resultsExt     = ".pcscan"
+)
+
+var errResultsInvalid = errors.New("invalid scan results file")
+
+// resultsHeader describes the scan a results file was saved from.
+type resultsHeader struct {
+	Dump     string
+	Time     time.Time
+	Database [sha1.Size]byte
+}
+
+type resultsGroup struct {
+	key    string // root + "/" + title ID
+	offset int64  // from the start of the groups
+	length int64
+	sum    [sha1.Size]byte
+}
+
+// recordKey identifies a finding within its group across scans: DLC by
+// content ID, anything else by its path inside the title directory, so a
+// replaced title update shows up as changed rather than removed and new.
+func recordKey(f *finding) string {
+	if f.ContentID != "" {
+		return f.Kind + ":" + f.ContentID
+	}
+	return f.Kind + ":" + f.Path
+}
+
+func groupKey(f *finding) string {
+	return f.Root + "/" + f.TitleID
+}
+
+// scanRecorder collects the findings of a scan as they are emitted.
+type scanRecorder struct {
+	mu       sync.Mutex
+	header   resultsHeader
+	findings []finding
+}
+
+func newScanRecorder(dump string) *scanRecorder {
+	return &scanRecorder{header: resultsHeader{Dump: dump, Time: time.Now(), Database: currentTitles().digest}}
+}
+
+// recordingSink passes results on to another sink, recording their findings.
+type recordingSink struct {
+	scanSink
+	rec *scanRecorder
+}
+
+func (s recordingSink) emit(r *titleResult) {
+	s.rec.mu.Lock()
+	s.rec.findings = append(s.rec.findings, r.findings...)
+	s.rec.mu.Unlock()
+	s.scanSink.emit(r)
+}
+
+// recordResults wraps sink so the findings of a complete scan of roots are
+// saved to -results (and kept for the GUI's Save Output). The returned
+// function saves them once the scan returns err; scans of some title
+// directories only, such as those of -watch, are not recorded.
+func recordResults(src *dumpSource, roots []scanRoot, sink scanSink) (scanSink, func(error) error) {
+	for _, root := range roots {
+		if root.titleDirs != nil {
+			return sink, func(err error) error { return err }
+		}
+	}
+	if resultsPath == "" && !guiEnabled {
+		return sink, func(err error) error { return err }
+	}
+
+	rec := newScanRecorder(src.display)
+	return recordingSink{sink, rec}, func(err error) error {
+		if err != nil {
+			return err
+		}
+		if guiEnabled {
+			guiLastScan.Store(rec)
+		}
+		if resultsPath != "" {
+			if err := rec.save(resultsPath); err != nil {
+				return fmt.Errorf("error saving scan results: %v", err)
+			}
+			fmt.Fprintf(statusOut, "Scan results saved to: %s\n", resultsPath)
+		}
+		return nil
+	}
+}
+
+func appendFinding(buf []byte, f *finding) []byte {
+	buf = appendString(buf, f.Kind)
+	buf = binary.AppendUvarint(buf, uint64(f.Status))
+	buf = appendString(buf, f.ContentID)
+	buf = appendString(buf, f.Path)
+	buf = appendString(buf, f.TitleName)
+	buf = appendString(buf, f.SHA1)
+	buf = appendString(buf, f.Name)
+	buf = binary.AppendUvarint(buf, uint64(f.Size))
+	buf = appendString(buf, f.Fingerprint)
+	buf = appendString(buf, f.DisplayName)
+	if f.XBE == nil {
+		return append(buf, 0)
+	}
+	buf = append(buf, 1)
+	buf = appendString(buf, f.XBE.TitleID)
+	buf = appendString(buf, f.XBE.TitleName)
+	buf = binary.AppendUvarint(buf, uint64(f.XBE.Version))
+	return binary.AppendUvarint(buf, uint64(f.XBE.Built.Unix()))
+}
+
+func (r *snapshotReader) finding(root, titleID string) finding {
+	f := finding{Root: root, TitleID: titleID}
+	f.Kind = r.string()
+	status := r.uvarint64()
+	if status >= uint64(numFindingStatuses) {
+		r.err = errResultsInvalid
+		return f
+	}
+	f.Status = findingStatus(status)
+	f.ContentID = r.string()
+	f.Path = r.string()
+	f.TitleName = r.string()
+	f.SHA1 = r.string()
+	f.Name = r.string()
+	f.Size = int64(r.uvarint64())
+	f.Fingerprint = r.string()
+	f.DisplayName = r.string()
+	if r.err != nil || r.off >= len(r.data) {
+		r.err = errResultsInvalid
+		return f
+	}
+	hasXBE := r.data[r.off] == 1
+	r.off++
+	if hasXBE {
+		f.XBE = &xbeHeader{TitleID: r.string(), TitleName: r.string(), Version: uint32(r.uvarint64())}
+		f.XBE.Built = time.Unix(int64(r.uvarint64()), 0)
+	}
+	return f
+}
+
+// save writes the recorded findings to name, through a temporary file.
+func (rec *scanRecorder) save(name string) error {
+	rec.mu.Lock()
+	findings := append([]finding(nil), rec.findings...)
+	rec.mu.Unlock()
+
+	sort.SliceStable(findings, func(i, j int) bool {
+		gi, gj := groupKey(&findings[i]), groupKey(&findings[j])
+		if gi != gj {
+			return gi < gj
+		}
+		return recordKey(&findings[i]) < recordKey(&findings[j])
+	})
+
+	var groups []resultsGroup
+	var data []byte
+	for i := 0; i < len(findings); {
+		key := groupKey(&findings[i])
+		j := i
+		for j < len(findings) && groupKey(&findings[j]) == key {
+			j++
+		}
+		start := len(data)
+		data = binary.AppendUvarint(data, uint64(j-i))
+		for k := i; k < j; k++ {
+			data = appendFinding(data, &findings[k])
+		}
+		groups = append(groups, resultsGroup{
+			key:    key,
+			offset: int64(start),
+			length: int64(len(data) - start),
+			sum:    sha1.Sum(data[start:]),
+		})
+		i = j
+	}
+
+	index := appendString(nil, rec.header.Dump)
+	index = binary.AppendUvarint(index, uint64(rec.header.Time.Unix()))
+	index = append(index, rec.header.Database[:]...)
+	index = binary.AppendUvarint(index, uint64(len(groups)))
+	for _, g := range groups {
+		index = appendString(index, g.key)
+		index = binary.AppendUvarint(index, uint64(g.offset))
+		index = binary.AppendUvarint(index, uint64(g.length))
+		index = append(index, g.sum[:]...)
+	}
+
+	buf := append([]byte(nil), resultsMagic...)
+	buf = binary.AppendUvarint(buf, resultsVersion)
+	buf = binary.AppendUvarint(buf, uint64(len(index)))
+	buf = append(buf, index...)
+	buf = append(buf, data...)
+
+	if dir := filepath.Dir(name); dir != "." {
+		if err := os.MkdirAll(dir, 0o755); err != nil {
+			return err
+		}
+	}
+	tmpPath := name + ".tmp"
+	if err := os.WriteFile(tmpPath, buf, 0o644); err != nil {
+		return err
+	}
+	return os.Rename(tmpPath, name)
+}
+
+// resultsFile is an open results file whose index has been read.
+type resultsFile struct {
+	file   *os.File
+	header resultsHeader
+	groups []resultsGroup
+	data   int64 // offset of the groups in the file
+}
+
+func openResults(name string) (*resultsFile, error) {
+	file, err := os.Open(name)
+	if err != nil {
+		return nil, err
+	}
+	rf, err := readResultsIndex(file)
+	if err != nil {
+		file.Close()
+		return nil, fmt.Errorf("%s: %w", name, err)
+	}
+	return rf, nil
+}
+
+func readResultsIndex(file *os.File) (*resultsFile, error) {
+	br := bufio.NewReader(file)
+	magic := make([]byte, len(resultsMagic))
+	if _, err := io.ReadFull(br, magic); err != nil || string(magic) != resultsMagic {
+		return nil, errResultsInvalid
+	}
+	version, err := binary.ReadUvarint(br)
+	if err != nil || version != resultsVersion {
+		return nil, errResultsInvalid
+	}
+	indexLen, err := binary.ReadUvarint(br)
+	if err != nil || indexLen > 1<<30 {
+		return nil, errResultsInvalid
+	}
+	index := make([]byte, indexLen)
+	if _, err := io.ReadFull(br, index); err != nil {
+		return nil, errResultsInvalid
+	}
+
+	rf := &resultsFile{file: file}
+	rf.data = int64(len(resultsMagic)+uvarintLen(version)+uvarintLen(indexLen)) + int64(indexLen)
+	r := &snapshotReader{data: string(index)}
+	rf.header.Dump = r.string()
+	rf.header.Time = time.Unix(int64(r.uvarint64()), 0)
+	rf.header.Database = r.sum()
+	count := r.uvarint()
+	rf.groups = make([]resultsGroup, 0, count)
+	for i := 0; i < count && r.err == nil; i++ {
+		g := resultsGroup{key: r.string(), offset: int64(r.uvarint64()), length: int64(r.uvarint64())}
+		g.sum = r.sum()
+		rf.groups = append(rf.groups, g)
+	}
+	if r.err != nil {
+		return nil, errResultsInvalid
+	}
+
+	// Every group must lie within the file, so a corrupt index cannot make
+	// read allocate more than the file holds
+	info, err := file.Stat()
+	if err != nil {
+		return nil, err
+	}
+	size := info.Size() - rf.data
+	for _, g := range rf.groups {
+		if g.offset < 0 || g.length < 0 || g.offset > size || g.length > size-g.offset {
+			return nil, errResultsInvalid
+		}
+	}
+	return rf, nil
+}
+
+func uvarintLen(v uint64) int {
+	return len(binary.AppendUvarint(nil, v))
+}
+
+func (rf *resultsFile) Close() error {
+	return rf.file.Close()
+}
+
+// read decodes the findings of group g.
+func (rf *resultsFile) read(g resultsGroup) ([]finding, error) {
+	buf := make([]byte, g.length)
+	if _, err := rf.file.ReadAt(buf, rf.data+g.offset); err != nil {
+		return nil, errResultsInvalid
+	}
+	root, titleID, _ := strings.Cut(g.key, "/")
+	r := &snapshotReader{data: string(buf)}
+	count := r.uvarint()
+	findings := make([]finding, 0, count)
+	for i := 0; i < count && r.err == nil; i++ {
+		findings = append(findings, r.finding(root, titleID))
+	}
+	if r.err != nil || r.off != len(r.data) {
+		return nil, errResultsInvalid
+	}
+	return findings, nil
+}
+
+// resultsDiff is one difference between two saved scans.
+type resultsDiff struct {
+	Type   string   `json:"type"`   // "diff"
+	Change string   `json:"change"` // "new", "removed" or "changed"
+	Old    *finding `json:"old,omitempty"`
+	New    *finding `json:"new,omitempty"`
+}
+
+// diffResults compares two results files, calling emit for every
+// difference in key order. Groups with the same SHA1 are not read.
+func diffResults(older, newer *resultsFile, emit func(resultsDiff)) (compared, skipped int, err error) {
+	i, j := 0, 0
+	for i < len(older.groups) || j < len(newer.groups) {
+		var og, ng *resultsGroup
+		switch {
+		case j == len(newer.groups) || i < len(older.groups) && older.groups[i].key < newer.groups[j].key:
+			og = &older.groups[i]
+			i++
+		case i == len(older.groups) || newer.groups[j].key < older.groups[i].key:
+			ng = &newer.groups[j]
+			j++
+		default:
+			og, ng = &older.groups[i], &newer.groups[j]
+			i++
+			j++
+		}
+		compared++
+		if og != nil && ng != nil && og.sum == ng.sum {
+			skipped++
+			continue
+		}
+
+		var before, after []finding
+		if og != nil {
+			if before, err = older.read(*og); err != nil {
+				return compared, skipped, err
+			}
+		}
+		if ng != nil {
+			if after, err = newer.read(*ng); err != nil {
+				return compared, skipped, err
+			}
+		}
+		diffFindings(before, after, emit)
+	}
+	return compared, skipped, nil
+}
+
+func diffFindings(before, after []finding, emit func(resultsDiff)) {
+	i, j := 0, 0
+	for i < len(before) || j < len(after) {
+		switch {
+		case j == len(after) || i < len(before) && recordKey(&before[i]) < recordKey(&after[j]):
+			emit(resultsDiff{Type: "diff", Change: "removed", Old: &before[i]})
+			i++
+		case i == len(before) || recordKey(&after[j]) < recordKey(&before[i]):
+			emit(resultsDiff{Type: "diff", Change: "new", New: &after[j]})
+			j++
+		default:
+			if len(findingChanges(&before[i], &after[j])) > 0 {
+				emit(resultsDiff{Type: "diff", Change: "changed", Old: &before[i], New: &after[j]})
+			}
+			i++
+			j++
+		}
+	}
+}
+
+// findingChanges describes what differs between two records with the same key.
+func findingChanges(a, b *finding) []string {
+	var changes []string
+	compare := func(what, x, y string) {
+		if x != y {
+			changes = append(changes, fmt.Sprintf("%s %s -> %s", what, orNone(x), orNone(y)))
+		}
+	}
+	compare("status", findingStatusNames[a.Status], findingStatusNames[b.Status])
+	compare("SHA1", a.SHA1, b.SHA1)
+	compare("name", a.Name, b.Name)
+	if a.Size != b.Size {
+		compare("size", fmt.Sprint(a.Size), fmt.Sprint(b.Size))
+	}
+	compare("fingerprint", a.Fingerprint, b.Fingerprint)
+	compare("display name", a.DisplayName, b.DisplayName)
+	var xa, xb string
+	if a.XBE != nil {
+		xa = a.XBE.String()
+	}
+	if b.XBE != nil {
+		xb = b.XBE.String()
+	}
+	compare("XBE", xa, xb)
+	return changes
+}
+
+func orNone(s string) string {
+	if s == "" {
+		return "(none)"
+	}
+	return s
+}
+
+// describe names the content of a finding for diff output.
+func (f *finding) describe() string {
+	var text string
+	switch f.Kind {
+	case "dlc":
+		text = "DLC " + f.Path
+	case "update":
+		text = "Title update " + f.Path
+	default:
+		text = "XBE " + f.Path
+	}
+	if f.Root != "" {
+		text = f.Root + ": " + text
+	}
+	if f.TitleName != "" {
+		text += " (" + f.TitleName + ")"
+	}
+	return text
+}
+
+// runDiff prints the differences between two saved scans.
+func runDiff(oldPath, newPath string) error {
+	older, err := openResults(oldPath)
+	if err != nil {
+		return err
+	}
+	defer older.Close()
+	newer, err := openResults(newPath)
+	if err != nil {
+		return err
+	}
+	defer newer.Close()
+
+	var w *bufio.Writer
+	var jsonl *jsonlSink
+	if outputFormat == "jsonl" {
+		w = bufio.NewWriter(os.Stdout)
+		defer w.Flush()
+		jsonl = newJSONLSink(w)
+	}
+
+	r := &titleResult{}
+	r.addHeader("Scan Diff")
+	r.addInfo(levelInfo, "Old: %s (%s, %s)", older.header.Dump, older.header.Time.Format("2006-01-02 15:04:05"), oldPath)
+	r.addInfo(levelInfo, "New: %s (%s, %s)", newer.header.Dump, newer.header.Time.Format("2006-01-02 15:04:05"), newPath)
+	if older.header.Database != newer.header.Database {
+		r.addInfo(levelWarn, "The scans used different title databases; status changes may come from the database")
+	}
+	if jsonl == nil {
+		r.flush()
+	} else {
+		for _, line := range r.lines {
+			fmt.Fprintln(statusOut, line.text)
+		}
+	}
+
+	counts := make(map[string]int)
+	compared, skipped, err := diffResults(older, newer, func(d resultsDiff) {
+		counts[d.Change]++
+		if jsonl != nil {
+			jsonl.mu.Lock()
+			jsonl.enc.Encode(d)
+			jsonl.mu.Unlock()
+			return
+		}
+		r := &titleResult{}
+		switch d.Change {
+		case "new":
+			r.addInfo(levelGood, "New: %s [%s]", d.New.describe(), findingStatusNames[d.New.Status])
+		case "removed":
+			r.addInfo(levelError, "Removed: %s [%s]", d.Old.describe(), findingStatusNames[d.Old.Status])
+		default:
+			r.addInfo(levelWarn, "Changed: %s: %s", d.New.describe(), strings.Join(findingChanges(d.Old, d.New), ", "))
+		}
+		r.flush()
+	})
+	if err != nil {
+		return err
+	}
+
+	r = &titleResult{}
+	r.addHeader("Diff Summary")
+	r.addInfo(levelInfo, "New: %d, removed: %d, changed: %d", counts["new"], counts["removed"], counts["changed"])
+	r.addInfo(levelInfo, "Title directories compared: %d (%d unchanged, not read)", compared, skipped)
+	if jsonl == nil {
+		r.flush()
+	} else {
+		for _, line := range r.lines[1:] {
+			fmt.Fprintln(statusOut, line.text)
+		}
+	}
+	return nil
+}
+
+// resultsPathFor is where a text report's results file goes.
+func resultsPathFor(report string) string {
+	return strings.TrimSuffix(report, filepath.Ext(report)) + resultsExt
+}
@@ -0,0 +1,155 @@
+package main
+
+import (
+	"bytes"
+	"os"
+	"path/filepath"
+	"reflect"
+	"sort"
+	"testing"
+	"time"
+)
+
+func testFindings() []finding {
+	return []finding{
+		{Kind: "dlc", Status: statusArchived, TitleID: "4d530004", TitleName: "Halo 2", ContentID: "4d53000400000001", Name: "Map Pack", Path: "$c/4d53000400000001", DisplayName: "Multiplayer Map Pack"},
+		{Kind: "update", Status: statusUnknown, TitleID: "4d530004", TitleName: "Halo 2", SHA1: "0123456789abcdef0123456789abcdef01234567", Path: "$u/default.xbe",
+			XBE: &xbeHeader{TitleID: "4d530004", TitleName: "Halo 2", Version: 3, Built: time.Unix(1100000000, 0)}},
+		{Kind: "update", Status: statusUnknown, TitleID: "4d530004", Size: 1 << 20, Path: "$u/other.xbe"},
+		{Kind: "dlc", Status: statusUnknown, Root: "E", TitleID: "41560017", ContentID: "4156001700000009", Fingerprint: "fedcba9876543210fedcba9876543210fedcba98", Path: "$c/4156001700000009"},
+	}
+}
+
+func saveTestResults(t *testing.T, name string, findings []finding) string {
+	t.Helper()
+	rec := &scanRecorder{header: resultsHeader{Dump: "dump", Time: time.Unix(1700000000, 0), Database: testSourceHash("results")}}
+	rec.findings = findings
+	path := filepath.Join(t.TempDir(), name)
+	if err := rec.save(path); err != nil {
+		t.Fatal(err)
+	}
+	return path
+}
+
+// readAllResults reads every group of the results file at path.
+func readAllResults(path string) (*resultsFile, []finding, error) {
+	rf, err := openResults(path)
+	if err != nil {
+		return nil, nil, err
+	}
+	defer rf.Close()
+	var all []finding
+	for _, g := range rf.groups {
+		findings, err := rf.read(g)
+		if err != nil {
+			return rf, all, err
+		}
+		all = append(all, findings...)
+	}
+	return rf, all, nil
+}
+
+func TestResultsRoundTrip(t *testing.T) {
+	want := testFindings()
+	rf, got, err := readAllResults(saveTestResults(t, "scan.pcscan", want))
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	header := resultsHeader{Dump: "dump", Time: time.Unix(1700000000, 0), Database: testSourceHash("results")}
+	if !reflect.DeepEqual(rf.header, header) {
+		t.Errorf("header = %+v, want %+v", rf.header, header)
+	}
+	var keys []string
+	for _, g := range rf.groups {
+		keys = append(keys, g.key)
+	}
+	if wantKeys := []string{"/4d530004", "E/41560017"}; !reflect.DeepEqual(keys, wantKeys) {
+		t.Errorf("groups = %q, want %q", keys, wantKeys)
+	}
+
+	sort.SliceStable(want, func(i, j int) bool {
+		if gi, gj := groupKey(&want[i]), groupKey(&want[j]); gi != gj {
+			return gi < gj
+		}
+		return recordKey(&want[i]) < recordKey(&want[j])
+	})
+	if !reflect.DeepEqual(got, want) {
+		t.Errorf("findings = %+v\nwant %+v", got, want)
+	}
+}
+
+func TestResultsDiff(t *testing.T) {
+	before := testFindings()
+	after := testFindings()
+	after[0].Status, after[0].Name = statusUnarchived, "" // changed
+	after = append(after[:2], after[3:]...)               // removed
+	after = append(after, finding{Kind: "dlc", Status: statusUnknown, TitleID: "4d530004", ContentID: "4d53000400000002", Path: "$c/4d53000400000002"})
+
+	older, err := openResults(saveTestResults(t, "old.pcscan", before))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer older.Close()
+	newer, err := openResults(saveTestResults(t, "new.pcscan", after))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer newer.Close()
+
+	var changes []string
+	compared, skipped, err := diffResults(older, newer, func(d resultsDiff) {
+		f := d.New
+		if f == nil {
+			f = d.Old
+		}
+		changes = append(changes, d.Change+" "+recordKey(f))
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if compared != 2 || skipped != 1 {
+		t.Errorf("compared %d groups and skipped %d, want 2 and 1", compared, skipped)
+	}
+	want := []string{"changed dlc:4d53000400000001", "new dlc:4d53000400000002", "removed update:$u/other.xbe"}
+	if !reflect.DeepEqual(changes, want) {
+		t.Errorf("changes = %q, want %q", changes, want)
+	}
+}
+
+func TestResultsTruncated(t *testing.T) {
+	path := saveTestResults(t, "scan.pcscan", testFindings())
+	data, err := os.ReadFile(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	for n := 0; n < len(data); n++ {
+		if err := os.WriteFile(path, data[:n], 0o644); err != nil {
+			t.Fatal(err)
+		}
+		if _, _, err := readAllResults(path); err == nil {
+			t.Fatalf("reading the first %d of %d bytes succeeded", n, len(data))
+		}
+	}
+}
+
+// TestResultsCorrupt flips every byte of a results file in turn; reading
+// it must fail or return findings, never panic.
+func TestResultsCorrupt(t *testing.T) {
+	path := saveTestResults(t, "scan.pcscan", testFindings())
+	data, err := os.ReadFile(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	for i := range data {
+		corrupt := bytes.Clone(data)
+		corrupt[i] ^= 0xff
+		if err := os.WriteFile(path, corrupt, 0o644); err != nil {
+			t.Fatal(err)
+		}
+		_, _, err := readAllResults(path)
+		if i < len(resultsMagic) && err == nil {
+			t.Errorf("a file with a corrupt magic was read")
+		}
+	}
+}
@@ -0,0 +1,246 @@
+package main
+
+import (
+	"context"
+	"encoding/hex"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"net"
+	"net/http"
+	"strings"
+	"time"
+)
+
+// classification is the answer to a content ID or SHA1 query, classified
+// the way a scan classifies what it finds.
+type classification struct {
+	Kind      string        `json:"kind"` // "dlc" or "update"
+	Status    findingStatus `json:"status"`
+	TitleID   string        `json:"titleId,omitempty"`
+	TitleName string        `json:"titleName,omitempty"`
+	ContentID string        `json:"contentId,omitempty"`
+	SHA1      string        `json:"sha1,omitempty"`
+	Name      string        `json:"name,omitempty"`
+
+	Fingerprint string `json:"fingerprint,omitempty"` // recorded content fingerprint
+}
+
+type serverStatus struct {
+	Version    string `json:"version"`
+	Titles     int    `json:"titles"`
+	Database   string `json:"database"` // SHA1 of the loaded id_database.json
+	HashCache  bool   `json:"hashCache"`
+	Refreshing bool   `json:"refreshing"`
+}
+
+// runServer answers classification queries and runs scans over HTTP until
+// ctx is done, with the title database and hash cache kept loaded between
+// requests. Scans still running when it stops are cancelled.
+func runServer(ctx context.Context, addr string, jsonFilePath string) error {
+	listener, err := net.Listen("tcp", addr)
+	if err != nil {
+		return err
+	}
+	srv := &http.Server{
+		Handler:           newServerMux(jsonFilePath),
+		ReadHeaderTimeout: 10 * time.Second,
+		BaseContext:       func(net.Listener) context.Context { return ctx },
+	}
+	go func() {
+		<-ctx.Done()
+		shutdownCtx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+		defer cancel()
+		srv.Shutdown(shutdownCtx)
+	}()
+
+	if !noHashCache {
+		openHashCache()
+	}
+	fmt.Fprintf(statusOut, "Serving on http://%s\n", listener.Addr())
+	if err := srv.Serve(listener); !errors.Is(err, http.ErrServerClosed) {
+		return err
+	}
+	return nil
+}
+
+func newServerMux(jsonFilePath string) *http.ServeMux {
+	mux := http.NewServeMux()
+	mux.HandleFunc("/v1/status", serveStatus)
+	mux.HandleFunc("/v1/content", serveContent)
+	mux.HandleFunc("/v1/sha1", serveSHA1)
+	mux.HandleFunc("/v1/scan", serveScan)
+	mux.HandleFunc("/v1/refresh", func(w http.ResponseWriter, r *http.Request) {
+		serveRefresh(w, r, jsonFilePath)
+	})
+	return mux
+}
+
+func writeJSON(w http.ResponseWriter, code int, v interface{}) {
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(code)
+	json.NewEncoder(w).Encode(v)
+}
+
+func writeError(w http.ResponseWriter, code int, format string, args ...interface{}) {
+	writeJSON(w, code, jsonlError{Type: "error", Message: fmt.Sprintf(format, args...)})
+}
+
+func allowMethod(w http.ResponseWriter, r *http.Request, method string) bool {
+	if r.Method == method || method == http.MethodGet && r.Method == http.MethodHead {
+		return true
+	}
+	w.Header().Set("Allow", method)
+	writeError(w, http.StatusMethodNotAllowed, "%s only", method)
+	return false
+}
+
+// GET /v1/status
+func serveStatus(w http.ResponseWriter, r *http.Request) {
+	if !allowMethod(w, r, http.MethodGet) {
+		return
+	}
+	titles := currentTitles()
+	writeJSON(w, http.StatusOK, serverStatus{
+		Version:    version,
+		Titles:     len(titles.Titles),
+		Database:   hex.EncodeToString(titles.digest[:]),
+		HashCache:  !noHashCache,
+		Refreshing: titleDBRefresh.Load(),
+	})
+}
+
+// GET /v1/content?titleId=4d530064&contentId=4d53006400000003
+func serveContent(w http.ResponseWriter, r *http.Request) {
+	if !allowMethod(w, r, http.MethodGet) {
+		return
+	}
+	titleID := strings.ToLower(r.URL.Query().Get("titleId"))
+	contentID := strings.ToLower(r.URL.Query().Get("contentId"))
+	if titleID == "" || contentID == "" {
+		writeError(w, http.StatusBadRequest, "titleId and contentId are required")
+		return
+	}
+
+	titles := currentTitles()
+	c := classification{Kind: "dlc", TitleID: titleID, ContentID: contentID}
+	if titleData, ok := titles.Titles[titleID]; ok {
+		c.TitleName = titleData.TitleName
+		c.Status, c.Name = titles.contentStatus(titleID, contentID)
+		c.Fingerprint, _ = titles.recordedFingerprint(titleID, contentID)
+	} else {
+		// A scan reports content of an unknown title as found in an
+		// unrecognized directory
+		c.Status = statusUnrecognizedDir
+	}
+	writeJSON(w, http.StatusOK, c)
+}
+
+// GET /v1/sha1?sha1=<hash>[&titleId=4d530064]
+//
+// Without a titleId, an update filed under any title is known-archived; with
+// one, an update filed under another title is misfiled.
+func serveSHA1(w http.ResponseWriter, r *http.Request) {
+	if !allowMethod(w, r, http.MethodGet) {
+		return
+	}
+	hash := strings.ToLower(r.URL.Query().Get("sha1"))
+	titleID := strings.ToLower(r.URL.Query().Get("titleId"))
+	if sum, err := hex.DecodeString(hash); err != nil || len(sum) != 20 {
+		writeError(w, http.StatusBadRequest, "sha1 must be 40 hex digits")
+		return
+	}
+
+	titles := currentTitles()
+	c := classification{Kind: "update", SHA1: hash, TitleID: titleID}
+	var update knownUpdate
+	c.Status, update = titles.updateStatus(titleID, hash)
+	if c.Status != statusUnknown {
+		c.TitleID, c.Name = update.titleID, update.name
+	}
+	c.TitleName = titles.Titles[c.TitleID].TitleName
+	writeJSON(w, http.StatusOK, c)
+}
+
+// POST /v1/scan?path=<dump>[&roots=TDATA,E]
+//
+// The results stream back as JSON Lines, as with -format=jsonl, while the
+// scan runs. Closing the connection cancels the scan.
+func serveScan(w http.ResponseWriter, r *http.Request) {
+	if !allowMethod(w, r, http.MethodPost) {
+		return
+	}
+	location := r.URL.Query().Get("path")
+	if location == "" {
+		writeError(w, http.StatusBadRequest, "path is required")
+		return
+	}
+	names := selectedRoots
+	if value := r.URL.Query().Get("roots"); value != "" {
+		var err error
+		if names, err = parseScanRoots(value); err != nil {
+			writeError(w, http.StatusBadRequest, "%v", err)
+			return
+		}
+	}
+
+	src, err := openDump(location)
+	if err != nil {
+		writeError(w, http.StatusNotFound, "%v", err)
+		return
+	}
+	defer src.Close()
+	roots, err := src.namedRoots(names)
+	if err != nil {
+		writeError(w, http.StatusNotFound, "%v", err)
+		return
+	}
+
+	w.Header().Set("Content-Type", "application/x-ndjson")
+	out := io.Writer(w)
+	if flusher, ok := w.(http.Flusher); ok {
+		out = flushWriter{w, flusher}
+	}
+	sink := newJSONLSink(out)
+	_, err = checkForContent(r.Context(), src, roots, sink, nil)
+	// Once the client is gone there is no one to tell
+	if err != nil && !errors.As(err, new(reportedError)) && !errors.Is(err, context.Canceled) {
+		sink.emit(&titleResult{err: err})
+	}
+}
+
+// flushWriter sends every write to the client straight away; jsonlSink
+// writes one line at a time.
+type flushWriter struct {
+	w io.Writer
+	f http.Flusher
+}
+
+func (fw flushWriter) Write(p []byte) (int, error) {
+	n, err := fw.w.Write(p)
+	fw.f.Flush()
+	return n, err
+}
+
+// POST /v1/refresh downloads the database in the background; queries and
+// scans keep using the loaded one until the new one is ready.
+func serveRefresh(w http.ResponseWriter, r *http.Request, jsonFilePath string) {
+	if !allowMethod(w, r, http.MethodPost) {
+		return
+	}
+	started := refreshTitleDatabase(jsonFilePath, func(err error) {
+		if err != nil {
+			fmt.Fprintf(statusOut, "Database refresh failed: %v\n", err)
+			return
+		}
+		fmt.Fprintln(statusOut, "Database refreshed")
+	})
+	if !started {
+		writeError(w, http.StatusConflict, "a database refresh is already running")
+		return
+	}
+	writeJSON(w, http.StatusAccepted, struct {
+		Status string `json:"status"`
+	}{"refreshing"})
+}
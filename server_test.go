@@ -0,0 +1,41 @@
+package main
+
+import (
+	"bytes"
+	"context"
+	"encoding/json"
+	"errors"
+	"strings"
+	"testing"
+)
+
+// TestScanReportsMissingRootOnce checks that a root missing by the time
+// the scan starts reaches a /v1/scan client as a single error.
+func TestScanReportsMissingRootOnce(t *testing.T) {
+	src, err := openDump(t.TempDir())
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer src.Close()
+
+	var out bytes.Buffer
+	sink := newJSONLSink(&out)
+	_, err = checkForContent(context.Background(), src, []scanRoot{{name: "TDATA", dir: "TDATA"}}, sink, nil)
+	if !errors.As(err, new(reportedError)) {
+		t.Fatalf("err = %v, want one already reported", err)
+	}
+
+	errorLines := 0
+	for _, line := range strings.Split(strings.TrimSpace(out.String()), "\n") {
+		var msg struct{ Type string }
+		if err := json.Unmarshal([]byte(line), &msg); err != nil {
+			t.Fatalf("%v: %s", err, line)
+		}
+		if msg.Type == "error" {
+			errorLines++
+		}
+	}
+	if errorLines != 1 {
+		t.Errorf("sent %d errors, want 1:\n%s", errorLines, out.String())
+	}
+}
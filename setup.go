@@ -1,12 +1,12 @@
 package main
 
 import (
+	"context"
 	"fmt"
 	"os"
 	"runtime"
 
 	"fyne.io/fyne/v2"
-	"fyne.io/fyne/v2/canvas"
 	"fyne.io/fyne/v2/theme"
 )
 
@@ -21,22 +21,21 @@ func checkDataFolder(dataFolder string) error {
 	return nil
 }
 
-func checkDatabaseFile(jsonFilePath string, jsonURL string, updateFlag bool, window ...fyne.Window) error {
+func checkDatabaseFile(ctx context.Context, jsonFilePath string, jsonURL string, updateFlag bool, window ...fyne.Window) error {
 	// Check if JSON file exists
 	if _, err := os.Stat(jsonFilePath); os.IsNotExist(err) {
 		// Prompt for download if JSON file doesn't exist
 		if guiEnabled {
 			if len(window) != 1 {
-				output1 := canvas.NewText("ERROR: Your local developer did not use the a function correctly!", theme.ErrorColor())
-				output2 := canvas.NewText("Please open a GitHub issue and show them this output", theme.ErrorColor())
-				outputContainer.Add(output1)
-				outputContainer.Add(output2)
+				addText(theme.ErrorColor(), "ERROR: Your local developer did not use the a function correctly!")
+				addText(theme.ErrorColor(), "Please open a GitHub issue and show them this output")
+				return fmt.Errorf("no window to show the download confirmation in")
 			}
 
-			guiShowDownloadConfirmation(window[0], jsonFilePath, jsonURL)
+			guiShowDownloadConfirmation(ctx, window[0], jsonFilePath, jsonURL)
 		} else {
 			if cliPromptForDownload(jsonURL) {
-				err := loadJSONData(jsonFilePath, "Xbox-Preservation-Project", "Pinecone", "data/id_database.json", &titles, true)
+				err := loadTitleDatabase(jsonFilePath, "data/id_database.json", true)
 				if err != nil {
 					return fmt.Errorf("error downloading data: %v ", err)
 				}
@@ -46,18 +45,18 @@ func checkDatabaseFile(jsonFilePath string, jsonURL string, updateFlag bool, win
 		}
 	} else if updateFlag {
 		// Handle manual update
-		err := loadJSONData(jsonFilePath, "Xbox-Preservation-Project", "Pinecone", jsonFilePath, &titles, true)
+		err := loadTitleDatabase(jsonFilePath, jsonFilePath, true)
 		if err != nil {
 			return fmt.Errorf("error updating data: %v", err)
 		}
 	} else {
 		// Load existing JSON data
-		err := loadJSONData(jsonFilePath, "Xbox-Preservation-Project", "Pinecone", jsonFilePath, &titles, false)
+		err := loadTitleDatabase(jsonFilePath, jsonFilePath, false)
 		if err != nil {
 			return fmt.Errorf("error loading data: %v", err)
 		}
 		if guiEnabled {
-			guiScanDump()
+			guiScanDump(ctx)
 		}
 	}
 	return nil
@@ -80,21 +79,33 @@ func checkDumpFolder(dumpLocation string) error {
 	return nil
 }
 
-func checkParsingSettings() error {
+func checkParsingSettings(ctx context.Context) error {
 	if titleIDFlag != "" {
 		// if the titleID flag is set, print stats for that title
 		printStats(titleIDFlag, false)
 	} else if summarizeFlag {
 		// if the summarize flag is set, print stats for all titles
 		printStats("", true)
+	} else if watchMode {
+		location := dumpLocation
+		if fatxplorer {
+			location = `X:\`
+		}
+		fmt.Fprintf(statusOut, "Watching %s for new and changed title directories...\n", location)
+		return watchDump(ctx, location)
 	} else if fatxplorer {
 		if runtime.GOOS == "windows" {
 			if _, err := os.Stat(`X:\`); os.IsNotExist(err) {
 				return fmt.Errorf(`FatXplorer's X: drive not found`)
 			} else {
-				fmt.Println("Checking for Content...")
-				fmt.Println("====================================================================================================")
-				err := checkForContent("X:\\TDATA")
+				src := dirSource(`X:\`)
+				roots, err := src.scanRoots()
+				if err != nil {
+					return err
+				}
+				fmt.Fprintln(statusOut, "Checking for Content...")
+				fmt.Fprintln(statusOut, "====================================================================================================")
+				err = runScan(ctx, src, roots)
 				if err != nil {
 					return err
 				}
@@ -104,13 +115,24 @@ func checkParsingSettings() error {
 		}
 	} else {
 		// If no flag is set, proceed normally
-		// Check if TDATA folder exists
-		if _, err := os.Stat(dumpLocation + "/TDATA"); os.IsNotExist(err) {
-			return fmt.Errorf("TDATA folder not found. Please place TDATA folder in the dump folder.")
+		// The dump is either a folder or a raw FATX drive image
+		src, err := openDump(dumpLocation)
+		if err != nil {
+			return err
+		}
+		defer src.Close()
+
+		// Check if the TDATA folder (or the other selected roots) exists
+		roots, err := src.scanRoots()
+		if err != nil {
+			if src.dir != "" && len(selectedRoots) == 1 && selectedRoots[0] == "TDATA" {
+				return fmt.Errorf("TDATA folder not found. Please place TDATA folder in the dump folder.")
+			}
+			return err
 		}
-		fmt.Println("Checking for Content...")
-		fmt.Println("====================================================================================================")
-		err := checkForContent(dumpLocation + "/TDATA")
+		fmt.Fprintln(statusOut, "Checking for Content...")
+		fmt.Fprintln(statusOut, "====================================================================================================")
+		err = runScan(ctx, src, roots)
 		if err != nil {
 			return err
 		}
@@ -0,0 +1,319 @@
+package main
+
+import (
+	"crypto/sha1"
+	"encoding/binary"
+	"errors"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+)
+
+// A snapshot is a compact binary copy of a decoded id_database.json. It is
+// written next to the JSON file and reused for as long as the SHA1 of the
+// JSON source matches, which skips comment stripping and encoding/json.
+//
+// Layout: magic, uvarint version, 20 byte source SHA1, then the title names
+// and the packed tables of the titleIndex (see index.go) in their sorted
+// order, so loading one fills the tables without building or sorting
+// anything. Strings are a uvarint length followed by the bytes, content IDs
+// 8 little-endian bytes and SHA1s their 20 bytes.
+
+const (
+	snapshotMagic   = "PCDB"
+	snapshotVersion = 6
+)
+
+var errSnapshotInvalid = errors.New("invalid database snapshot")
+
+func snapshotPath(jsonFilePath string) string {
+	return strings.TrimSuffix(jsonFilePath, filepath.Ext(jsonFilePath)) + ".pcdb"
+}
+
+func appendString(buf []byte, s string) []byte {
+	buf = binary.AppendUvarint(buf, uint64(len(s)))
+	return append(buf, s...)
+}
+
+func appendStringList(buf []byte, list []string) []byte {
+	buf = binary.AppendUvarint(buf, uint64(len(list)))
+	for _, s := range list {
+		buf = appendString(buf, s)
+	}
+	return buf
+}
+
+func appendBool(buf []byte, b bool) []byte {
+	if b {
+		return append(buf, 1)
+	}
+	return append(buf, 0)
+}
+
+func encodeSnapshot(t *TitleList, sourceHash [sha1.Size]byte) []byte {
+	ids := make([]string, 0, len(t.Titles))
+	for id := range t.Titles {
+		ids = append(ids, id)
+	}
+	sort.Strings(ids)
+
+	buf := append([]byte(nil), snapshotMagic...)
+	buf = binary.AppendUvarint(buf, snapshotVersion)
+	buf = append(buf, sourceHash[:]...)
+	buf = binary.AppendUvarint(buf, uint64(len(ids)))
+	for _, id := range ids {
+		buf = appendString(buf, id)
+		buf = appendString(buf, t.Titles[id].TitleName)
+	}
+
+	idx := t.index
+	buf = binary.AppendUvarint(buf, uint64(len(idx.titles)))
+	for _, title := range idx.titles {
+		buf = appendString(buf, title.id)
+		buf = binary.AppendUvarint(buf, uint64(title.stats.contentIDs))
+		buf = binary.AppendUvarint(buf, uint64(title.stats.titleUpdates))
+		buf = binary.AppendUvarint(buf, uint64(title.stats.knownUpdates))
+		buf = binary.AppendUvarint(buf, uint64(title.stats.archived))
+		buf = appendBool(buf, title.sized)
+	}
+	buf = binary.AppendUvarint(buf, uint64(idx.knownUpdateKeys))
+	buf = binary.AppendUvarint(buf, uint64(idx.archivedKeys))
+	buf = appendBool(buf, idx.sized)
+	buf = appendStringList(buf, idx.names)
+	buf = binary.AppendUvarint(buf, uint64(len(idx.content)))
+	for _, c := range idx.content {
+		buf = binary.LittleEndian.AppendUint64(buf, c.id)
+		buf = binary.AppendUvarint(buf, uint64(c.title))
+		buf = binary.AppendUvarint(buf, uint64(c.name))
+		buf = binary.AppendUvarint(buf, uint64(c.fingerprint))
+		buf = appendBool(buf, c.known)
+	}
+	buf = binary.AppendUvarint(buf, uint64(len(idx.fingerprints)))
+	for _, sum := range idx.fingerprints {
+		buf = append(buf, sum[:]...)
+	}
+	buf = binary.AppendUvarint(buf, uint64(len(idx.updates)))
+	for _, u := range idx.updates {
+		buf = append(buf, u.sum[:]...)
+		buf = binary.AppendUvarint(buf, uint64(u.title))
+		buf = binary.AppendUvarint(buf, uint64(u.name))
+	}
+	buf = binary.AppendUvarint(buf, uint64(len(idx.updateSizes)))
+	for _, size := range idx.updateSizes {
+		buf = binary.AppendUvarint(buf, uint64(size))
+	}
+	buf = binary.AppendUvarint(buf, uint64(len(idx.irregular)))
+	for _, c := range idx.irregular {
+		buf = binary.AppendUvarint(buf, uint64(c.title))
+		buf = appendString(buf, c.id)
+		buf = appendString(buf, c.name)
+		buf = appendString(buf, c.fingerprint)
+		buf = appendBool(buf, c.archived)
+		buf = appendBool(buf, c.known)
+	}
+	return buf
+}
+
+// snapshotReader decodes a snapshot. Every string it returns is a substring
+// of one copy of the file, so decoding allocates little beyond the slices
+// and maps of the TitleList itself.
+type snapshotReader struct {
+	data string
+	off  int
+	err  error
+}
+
+// uvarint64 reads a value that may be larger than the file, like a size.
+func (r *snapshotReader) uvarint64() uint64 {
+	if r.err != nil {
+		return 0
+	}
+	var v uint64
+	var shift uint
+	for {
+		if r.off >= len(r.data) || shift > 63 {
+			r.err = errSnapshotInvalid
+			return 0
+		}
+		b := r.data[r.off]
+		r.off++
+		v |= uint64(b&0x7f) << shift
+		if b < 0x80 {
+			break
+		}
+		shift += 7
+	}
+	return v
+}
+
+// uvarint reads a count or length.
+func (r *snapshotReader) uvarint() int {
+	v := r.uvarint64()
+	if r.err != nil {
+		return 0
+	}
+	if v > uint64(len(r.data)) {
+		// No count or length can exceed the size of the file.
+		r.err = errSnapshotInvalid
+		return 0
+	}
+	return int(v)
+}
+
+func (r *snapshotReader) string() string {
+	n := r.uvarint()
+	if r.err != nil {
+		return ""
+	}
+	if len(r.data)-r.off < n {
+		r.err = errSnapshotInvalid
+		return ""
+	}
+	s := r.data[r.off : r.off+n]
+	r.off += n
+	return s
+}
+
+func (r *snapshotReader) stringList() []string {
+	n := r.uvarint()
+	list := make([]string, 0, n)
+	for i := 0; i < n && r.err == nil; i++ {
+		list = append(list, r.string())
+	}
+	return list
+}
+
+func (r *snapshotReader) bool() bool {
+	return r.uvarint64() != 0
+}
+
+// uint64 reads 8 little-endian bytes.
+func (r *snapshotReader) uint64() uint64 {
+	if r.err != nil || len(r.data)-r.off < 8 {
+		r.err = errSnapshotInvalid
+		return 0
+	}
+	v := binary.LittleEndian.Uint64([]byte(r.data[r.off : r.off+8]))
+	r.off += 8
+	return v
+}
+
+// sum reads a 20 byte SHA1.
+func (r *snapshotReader) sum() (sum [sha1.Size]byte) {
+	if r.err != nil || len(r.data)-r.off < sha1.Size {
+		r.err = errSnapshotInvalid
+		return sum
+	}
+	copy(sum[:], r.data[r.off:])
+	r.off += sha1.Size
+	return sum
+}
+
+// ref reads a position in a table of n entries.
+func (r *snapshotReader) ref(n int) uint32 {
+	v := r.uvarint64()
+	if v >= uint64(n) {
+		r.err = errSnapshotInvalid
+		return 0
+	}
+	return uint32(v)
+}
+
+// decodeSnapshot fills t from data if it is a snapshot of the JSON source
+// with the given SHA1.
+func decodeSnapshot(data []byte, sourceHash [sha1.Size]byte, t *TitleList) error {
+	header := len(snapshotMagic)
+	if len(data) < header || string(data[:header]) != snapshotMagic {
+		return errSnapshotInvalid
+	}
+
+	r := &snapshotReader{data: string(data), off: header}
+	if r.uvarint() != snapshotVersion || r.err != nil {
+		return errSnapshotInvalid
+	}
+	if len(r.data)-r.off < sha1.Size || r.data[r.off:r.off+sha1.Size] != string(sourceHash[:]) {
+		return errSnapshotInvalid
+	}
+	r.off += sha1.Size
+
+	count := r.uvarint()
+	titleMap := make(map[string]TitleData, count)
+	for i := 0; i < count && r.err == nil; i++ {
+		id := r.string()
+		titleMap[id] = TitleData{TitleName: r.string()}
+	}
+
+	idx := &titleIndex{}
+	idx.titles = make([]indexedTitle, r.uvarint())
+	for i := range idx.titles {
+		title := &idx.titles[i]
+		title.id = r.string()
+		title.stats = titleCounts{contentIDs: r.uvarint(), titleUpdates: r.uvarint(), knownUpdates: r.uvarint(), archived: r.uvarint()}
+		title.sized = r.bool()
+	}
+	idx.knownUpdateKeys = r.uvarint()
+	idx.archivedKeys = r.uvarint()
+	idx.sized = r.bool()
+	idx.names = r.stringList()
+	idx.content = make([]indexedContent, r.uvarint())
+	fingerprintRefs := 0
+	for i := range idx.content {
+		c := &idx.content[i]
+		c.id = r.uint64()
+		c.title = r.ref(len(idx.titles))
+		c.name = r.ref(len(idx.names) + 1)
+		c.fingerprint = uint32(r.uvarint())
+		c.known = r.bool()
+		fingerprintRefs = max(fingerprintRefs, int(c.fingerprint))
+	}
+	idx.fingerprints = make([][sha1.Size]byte, r.uvarint())
+	for i := range idx.fingerprints {
+		idx.fingerprints[i] = r.sum()
+	}
+	if fingerprintRefs > len(idx.fingerprints) {
+		return errSnapshotInvalid
+	}
+	idx.updates = make([]indexedUpdate, r.uvarint())
+	for i := range idx.updates {
+		idx.updates[i] = indexedUpdate{sum: r.sum(), title: r.ref(len(idx.titles)), name: r.ref(len(idx.names))}
+	}
+	idx.updateSizes = make([]int64, r.uvarint())
+	for i := range idx.updateSizes {
+		idx.updateSizes[i] = int64(r.uvarint64())
+	}
+	idx.irregular = make([]irregularContent, r.uvarint())
+	for i := range idx.irregular {
+		idx.irregular[i] = irregularContent{title: r.ref(len(idx.titles)), id: r.string(), name: r.string(), fingerprint: r.string(), archived: r.bool(), known: r.bool()}
+	}
+	if r.err != nil {
+		return r.err
+	}
+	if r.off != len(r.data) {
+		return errSnapshotInvalid
+	}
+
+	t.Titles = titleMap
+	t.index = idx
+	return nil
+}
+
+// loadSnapshot decodes the snapshot for jsonFilePath if it is up to date.
+func loadSnapshot(jsonFilePath string, sourceHash [sha1.Size]byte, t *TitleList) error {
+	data, err := os.ReadFile(snapshotPath(jsonFilePath))
+	if err != nil {
+		return err
+	}
+	return decodeSnapshot(data, sourceHash, t)
+}
+
+// writeSnapshot replaces the snapshot for jsonFilePath. The file is written
+// under a temporary name first so a crash never leaves a truncated snapshot.
+func writeSnapshot(jsonFilePath string, sourceHash [sha1.Size]byte, t *TitleList) error {
+	path := snapshotPath(jsonFilePath)
+	tmpPath := path + ".tmp"
+	if err := os.WriteFile(tmpPath, encodeSnapshot(t, sourceHash), 0o644); err != nil {
+		return err
+	}
+	return os.Rename(tmpPath, path)
+}
@@ -0,0 +1,205 @@
+package main
+
+import (
+	"bytes"
+	"crypto/sha1"
+	"errors"
+	"os"
+	"path/filepath"
+	"reflect"
+	"testing"
+)
+
+// newTestTitleList returns a small indexed database that fills every table
+// of the snapshot: archived and fingerprinted content, sized and unsized
+// updates, an update filed under two titles and irregular content IDs.
+func newTestTitleList() *TitleList {
+	t := &TitleList{Titles: map[string]TitleData{
+		"4d530004": {
+			TitleName:    "Halo 2",
+			ContentIDs:   []string{"4D53000400000001", "4d53000400000002", "4d530004ffff"},
+			TitleUpdates: []string{"update 1", "update 2"},
+			TitleUpdatesKnown: []map[string]string{
+				{"0123456789abcdef0123456789abcdef01234567": "default.xbe (v1)"},
+				{"89abcdef0123456789abcdef0123456789abcdef": "default.xbe (v2)"},
+			},
+			Archived: []map[string]string{
+				{"4d53000400000001": "Map Pack"},
+				{"4d530004ffff": "Short ID"},
+			},
+			TitleUpdateSizes: map[string]int64{
+				"0123456789abcdef0123456789abcdef01234567": 1 << 20,
+				"89abcdef0123456789abcdef0123456789abcdef": 2 << 20,
+			},
+			Fingerprints: map[string]string{
+				"4d53000400000002": "fedcba9876543210fedcba9876543210fedcba98",
+				"4d530004ffff":     "not a fingerprint",
+			},
+		},
+		"41560017": {
+			TitleName:  "Project Gotham Racing 2",
+			ContentIDs: []string{"4156001700000001"},
+			TitleUpdatesKnown: []map[string]string{
+				{"0123456789abcdef0123456789abcdef01234567": "misfiled.xbe"},
+				{"not a sha1": "broken.xbe"},
+			},
+		},
+	}}
+	t.buildIndex()
+	return t
+}
+
+func testSourceHash(s string) [sha1.Size]byte {
+	return sha1.Sum([]byte(s))
+}
+
+// sameIndex reports whether two lists answer every lookup of the test list
+// the same way.
+func sameIndex(t *testing.T, want, got *TitleList) {
+	t.Helper()
+	if !reflect.DeepEqual(want.Titles, got.Titles) {
+		t.Errorf("titles = %v, want %v", got.Titles, want.Titles)
+	}
+	if w, g := encodeSnapshot(want, [sha1.Size]byte{}), encodeSnapshot(got, [sha1.Size]byte{}); !bytes.Equal(w, g) {
+		t.Errorf("index differs after decoding")
+	}
+	for _, titleID := range []string{"", "4d530004", "41560017", "00000000"} {
+		if w, g := want.counts(titleID), got.counts(titleID); w != g {
+			t.Errorf("counts(%q) = %+v, want %+v", titleID, g, w)
+		}
+		if w, g := want.contentIDs(titleID), got.contentIDs(titleID); !reflect.DeepEqual(w, g) {
+			t.Errorf("contentIDs(%q) = %v, want %v", titleID, g, w)
+		}
+	}
+	for _, contentID := range []string{"4d53000400000001", "4d53000400000002", "4d530004ffff", "4d53000400000003"} {
+		if w, g := want.lookupContent("4d530004", contentID), got.lookupContent("4d530004", contentID); w != g {
+			t.Errorf("lookupContent(%q) = %+v, want %+v", contentID, g, w)
+		}
+	}
+}
+
+func TestSnapshotRoundTrip(t *testing.T) {
+	want := newTestTitleList()
+	sum := testSourceHash("round trip")
+	var got TitleList
+	if err := decodeSnapshot(encodeSnapshot(want, sum), sum, &got); err != nil {
+		t.Fatal(err)
+	}
+	sameIndex(t, want, &got)
+
+	if info := got.lookupContent("4d530004", "4d530004ffff"); !info.known || info.name != "Short ID" || info.fingerprint != "not a fingerprint" {
+		t.Errorf("irregular content = %+v", info)
+	}
+	if update, ok, _ := got.findUpdate("41560017", "0123456789abcdef0123456789abcdef01234567"); !ok || update.name != "misfiled.xbe" {
+		t.Errorf("findUpdate = %+v, %v", update, ok)
+	}
+	for _, size := range []int64{1 << 20, 3 << 20} {
+		if w, g := want.mayBeKnownUpdate("4d530004", size), got.mayBeKnownUpdate("4d530004", size); w != g {
+			t.Errorf("mayBeKnownUpdate(%d) = %v, want %v", size, g, w)
+		}
+	}
+}
+
+func TestSnapshotDatabase(t *testing.T) {
+	want := currentTitles()
+	sum := testSourceHash("database")
+	var got TitleList
+	if err := decodeSnapshot(encodeSnapshot(want, sum), sum, &got); err != nil {
+		t.Fatal(err)
+	}
+	if !reflect.DeepEqual(want.Titles, got.Titles) {
+		t.Errorf("titles differ after decoding")
+	}
+	if w, g := want.counts(""), got.counts(""); w != g {
+		t.Errorf("counts = %+v, want %+v", g, w)
+	}
+	if !bytes.Equal(encodeSnapshot(want, sum), encodeSnapshot(&got, sum)) {
+		t.Errorf("index differs after decoding")
+	}
+}
+
+// TestSnapshotFile checks that a decoded JSON file writes a snapshot that
+// the next load uses.
+func TestSnapshotFile(t *testing.T) {
+	jsonPath := filepath.Join(t.TempDir(), "id_database.json")
+	data, err := os.ReadFile(testJSONPath)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if err := os.WriteFile(jsonPath, data, 0o644); err != nil {
+		t.Fatal(err)
+	}
+
+	var fromJSON TitleList
+	if err := decodeJSONFile(jsonPath, &fromJSON); err != nil {
+		t.Fatal(err)
+	}
+	var fromSnapshot TitleList
+	if err := loadSnapshot(jsonPath, sha1.Sum(data), &fromSnapshot); err != nil {
+		t.Fatal(err)
+	}
+	if fromJSON.digest != sha1.Sum(data) {
+		t.Errorf("digest = %x, want %x", fromJSON.digest, sha1.Sum(data))
+	}
+	if !bytes.Equal(encodeSnapshot(&fromJSON, fromJSON.digest), encodeSnapshot(&fromSnapshot, fromJSON.digest)) {
+		t.Errorf("snapshot differs from the decoded JSON")
+	}
+}
+
+func TestSnapshotStale(t *testing.T) {
+	data := encodeSnapshot(newTestTitleList(), testSourceHash("old"))
+	var got TitleList
+	if err := decodeSnapshot(data, testSourceHash("new"), &got); !errors.Is(err, errSnapshotInvalid) {
+		t.Errorf("decoding a snapshot of another source: err = %v", err)
+	}
+
+	// A snapshot of an older version is never read
+	sum := testSourceHash("old")
+	old := append([]byte(snapshotMagic), snapshotVersion-1)
+	old = append(old, data[len(snapshotMagic)+1:]...)
+	if err := decodeSnapshot(old, sum, &got); !errors.Is(err, errSnapshotInvalid) {
+		t.Errorf("decoding version %d: err = %v", snapshotVersion-1, err)
+	}
+	if got.Titles != nil || got.index != nil {
+		t.Errorf("a failed decode modified the list")
+	}
+}
+
+func TestSnapshotTruncated(t *testing.T) {
+	sum := testSourceHash("truncated")
+	data := encodeSnapshot(newTestTitleList(), sum)
+	for n := 0; n < len(data); n++ {
+		var got TitleList
+		if err := decodeSnapshot(data[:n], sum, &got); err == nil {
+			t.Fatalf("decoding the first %d of %d bytes succeeded", n, len(data))
+		}
+	}
+
+	var got TitleList
+	if err := decodeSnapshot(append(data, 0), sum, &got); !errors.Is(err, errSnapshotInvalid) {
+		t.Errorf("decoding with a trailing byte: err = %v", err)
+	}
+}
+
+// TestSnapshotCorrupt flips every byte of a snapshot in turn. Decoding must
+// fail or produce a list whose lookups stay within its tables.
+func TestSnapshotCorrupt(t *testing.T) {
+	sum := testSourceHash("corrupt")
+	data := encodeSnapshot(newTestTitleList(), sum)
+	for i := len(snapshotMagic); i < len(data); i++ {
+		corrupt := bytes.Clone(data)
+		corrupt[i] ^= 0xff
+		var got TitleList
+		if decodeSnapshot(corrupt, sum, &got) != nil {
+			continue
+		}
+		for titleID := range got.Titles {
+			got.counts(titleID)
+			for _, contentID := range got.contentIDs(titleID) {
+				got.lookupContent(titleID, contentID)
+			}
+			got.findUpdate(titleID, "0123456789abcdef0123456789abcdef01234567")
+			got.mayBeKnownUpdate(titleID, 1<<20)
+		}
+	}
+}
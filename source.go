@@ -0,0 +1,238 @@
+package main
+
+import (
+	"archive/zip"
+	"bytes"
+	"fmt"
+	"io"
+	"io/fs"
+	"os"
+	"path"
+	"path/filepath"
+	"strings"
+)
+
+// dumpSource is a filesystem holding a dump. It is either a plain directory,
+// a raw drive image read through the FATX reader or a zip archive; the
+// scanner only ever sees the fs.FS.
+type dumpSource struct {
+	fsys     fs.FS
+	dir      string // set for plain directories
+	display  string // prefixed to paths shown to the user
+	cacheID  string // prefixed to hash cache keys of non-directory sources
+	foldCase bool   // names are case-insensitive (FATX)
+	device   string // see deviceID; scans of one device share a hashing limit
+	closer   io.Closer
+}
+
+var (
+	zipMagic      = []byte("PK\x03\x04")
+	zipEmptyMagic = []byte("PK\x05\x06")
+	sevenZipMagic = []byte("7z\xbc\xaf\x27\x1c")
+)
+
+func dirSource(dir string) *dumpSource {
+	return &dumpSource{
+		fsys:    os.DirFS(dir),
+		dir:     dir,
+		display: dir,
+		device:  deviceID(dir),
+	}
+}
+
+// openDump opens location as a dump: a directory is used as is, a zip
+// archive is read in place and any other file or block device is read as a
+// raw FATX drive or partition image.
+func openDump(location string) (*dumpSource, error) {
+	info, err := os.Stat(location)
+	if err != nil {
+		return nil, err
+	}
+	if info.IsDir() {
+		return dirSource(location), nil
+	}
+
+	magic, err := readMagic(location)
+	if err != nil {
+		return nil, err
+	}
+	switch {
+	case bytes.HasPrefix(magic, zipMagic), bytes.HasPrefix(magic, zipEmptyMagic):
+		return openZipDump(location)
+	case bytes.HasPrefix(magic, sevenZipMagic):
+		return nil, fmt.Errorf("%s: 7z archives are not supported, extract the dump or repack it as a zip", location)
+	}
+
+	volume, err := openFATXImage(location, fatxPartition)
+	if err != nil {
+		return nil, fmt.Errorf("%s: %v", location, err)
+	}
+	display, cacheID := location, normalizeCachePath(location)
+	if volume.partition != "" {
+		// Full drive image: qualify paths with the partition letter.
+		display += ":" + volume.partition
+		cacheID += ":" + volume.partition
+	}
+	return &dumpSource{
+		fsys:     volume,
+		display:  display,
+		cacheID:  cacheID,
+		foldCase: true,
+		device:   deviceID(location),
+		closer:   volume,
+	}, nil
+}
+
+// openZipDump opens a zip archive as a dump. Entries are decompressed
+// straight into the hasher, nothing is extracted to disk.
+func openZipDump(location string) (*dumpSource, error) {
+	archive, err := zip.OpenReader(location)
+	if err != nil {
+		return nil, fmt.Errorf("%s: %v", location, err)
+	}
+	return &dumpSource{
+		fsys:    archive,
+		display: location,
+		cacheID: normalizeCachePath(location),
+		device:  deviceID(location),
+		closer:  archive,
+	}, nil
+}
+
+func readMagic(location string) ([]byte, error) {
+	file, err := os.Open(location)
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+	magic := make([]byte, len(sevenZipMagic))
+	n, err := io.ReadFull(file, magic)
+	if err != nil && err != io.ErrUnexpectedEOF && err != io.EOF {
+		return nil, err
+	}
+	return magic[:n], nil
+}
+
+func (d *dumpSource) Close() error {
+	if d.closer != nil {
+		return d.closer.Close()
+	}
+	return nil
+}
+
+// displayPath returns the user facing path of name, a path inside fsys.
+func (d *dumpSource) displayPath(name string) string {
+	if d.dir != "" {
+		return filepath.Join(d.dir, filepath.FromSlash(name))
+	}
+	return d.display + "/" + name
+}
+
+// cacheKey returns the hash cache key of name, a path inside fsys.
+func (d *dumpSource) cacheKey(name string) string {
+	if d.dir != "" {
+		return normalizeCachePath(filepath.Join(d.dir, filepath.FromSlash(name)))
+	}
+	name = path.Clean(name)
+	if d.foldCase {
+		name = strings.ToLower(name)
+	}
+	return d.cacheID + "/" + name
+}
+
+// scanRoot is one folder of a dump covered by a scan.
+type scanRoot struct {
+	name  string // TDATA, UDATA, C, E, F or G
+	dir   string // inside the dump's fs.FS
+	files bool   // check every .xbe instead of title directories
+
+	// titleDirs, if not nil, limits the scan to these title directories
+	// instead of walking dir
+	titleDirs []string
+}
+
+// scanRootNames lists the roots -roots=all expands to, in scan order.
+var scanRootNames = []string{"TDATA", "UDATA", "C", "E", "F", "G"}
+
+// parseScanRoots validates a -roots value: a comma separated list of root
+// names, or "all".
+func parseScanRoots(value string) ([]string, error) {
+	if strings.EqualFold(strings.TrimSpace(value), "all") {
+		return scanRootNames, nil
+	}
+	var names []string
+	for _, name := range strings.Split(value, ",") {
+		name = strings.ToUpper(strings.TrimSpace(name))
+		if name == "" {
+			continue
+		}
+		if !contains(scanRootNames, name) {
+			return nil, fmt.Errorf("unknown scan root %q, expected one of %s or all", name, strings.Join(scanRootNames, ", "))
+		}
+		if !contains(names, name) {
+			names = append(names, name)
+		}
+	}
+	if len(names) == 0 {
+		return nil, fmt.Errorf("no scan roots given")
+	}
+	return names, nil
+}
+
+// scanRoots resolves the roots selected with -roots.
+func (d *dumpSource) scanRoots() ([]scanRoot, error) {
+	return d.namedRoots(selectedRoots)
+}
+
+// namedRoots resolves the named roots. Roots missing from the dump are
+// skipped; it is only an error if none of them exist.
+func (d *dumpSource) namedRoots(names []string) ([]scanRoot, error) {
+	var roots []scanRoot
+	var firstErr error
+	for _, name := range names {
+		dir, err := d.findRoot(name)
+		if err != nil {
+			if firstErr == nil {
+				firstErr = err
+			}
+			continue
+		}
+		roots = append(roots, scanRoot{
+			name:  name,
+			dir:   dir,
+			files: name != "TDATA" && name != "UDATA",
+		})
+	}
+	if len(roots) == 0 {
+		if len(names) > 1 {
+			return nil, fmt.Errorf("none of %s found in %s", strings.Join(names, ", "), d.display)
+		}
+		return nil, firstErr
+	}
+	return roots, nil
+}
+
+// findRoot returns the named root folder of the dump, which may also be the
+// root of the dump itself. Archives often wrap the dump in a single top
+// level folder, so the root is also looked for one level down.
+func (d *dumpSource) findRoot(name string) (string, error) {
+	if info, err := fs.Stat(d.fsys, name); err == nil && info.IsDir() {
+		return name, nil
+	}
+	if d.dir == "" {
+		entries, _ := fs.ReadDir(d.fsys, ".")
+		for _, entry := range entries {
+			if !entry.IsDir() {
+				continue
+			}
+			dir := path.Join(entry.Name(), name)
+			if info, err := fs.Stat(d.fsys, dir); err == nil && info.IsDir() {
+				return dir, nil
+			}
+		}
+	}
+	if d.dir != "" && strings.EqualFold(filepath.Base(filepath.Clean(d.dir)), name) {
+		return ".", nil
+	}
+	return "", fmt.Errorf("%s folder not found in %s", name, d.display)
+}
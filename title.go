@@ -1,13 +1,22 @@
 package main
 
+import "crypto/sha1"
+
+// TitleData is a title as id_database.json stores it. Once a TitleList is
+// indexed only TitleName is kept; the rest is queried through its index.
 type TitleData struct {
 	TitleName         string              `json:"Title Name,"`
 	ContentIDs        []string            `json:"Content IDs"`
 	TitleUpdates      []string            `json:"Title Updates"`
 	TitleUpdatesKnown []map[string]string `json:"Title Updates Known"`
 	Archived          []map[string]string `json:"Archived"`
+	TitleUpdateSizes  map[string]int64    `json:"Title Update Sizes,omitempty"`   // SHA1 -> file size, optional
+	Fingerprints      map[string]string   `json:"Content Fingerprints,omitempty"` // content ID -> fingerprint, optional, see fingerprint.go
 }
 
 type TitleList struct {
 	Titles map[string]TitleData `json:"Titles"`
+
+	index  *titleIndex     // built by buildIndex, see index.go
+	digest [sha1.Size]byte // SHA1 of the database file the list was loaded from
 }
@@ -0,0 +1,320 @@
+package main
+
+import (
+	"context"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/fnv"
+	"io/fs"
+	"path"
+	"path/filepath"
+	"sort"
+	"strings"
+	"time"
+
+	"github.com/fsnotify/fsnotify"
+)
+
+const (
+	// watchDebounce is how long a dump has to be quiet before it is
+	// rescanned; copying a title folder or mounting a drive is a burst of
+	// events.
+	watchDebounce = time.Second
+	// watchMaxDelay bounds the wait during a long burst.
+	watchMaxDelay = 10 * time.Second
+	// watchPoll is how often the roots are checked without an event, which
+	// catches drives mounted over the watched folder.
+	watchPoll = 5 * time.Second
+)
+
+// dumpWatcher keeps a scan of a dump folder up to date.
+type dumpWatcher struct {
+	location string
+	watcher  *fsnotify.Watcher
+	src      *dumpSource // nil until the dump's roots exist
+	roots    []scanRoot
+
+	// Fingerprints of the title directories scanned so far, see
+	// titleFingerprint
+	fingerprints map[string]uint64
+	state        uint64 // see rootState
+	waiting      bool   // "waiting for" message shown
+}
+
+// watchDump scans location, then watches it until ctx is done and rescans
+// the title directories that appear or change. Results are printed like
+// those of any other scan, one set of results and a summary per change.
+func watchDump(ctx context.Context, location string) error {
+	for _, name := range selectedRoots {
+		if name != "TDATA" && name != "UDATA" {
+			return fmt.Errorf("watch mode only supports the TDATA and UDATA roots")
+		}
+	}
+	src, err := openDump(location)
+	if err != nil {
+		return err
+	}
+	src.Close()
+	if src.dir == "" {
+		return fmt.Errorf("watch mode needs a folder, %s is an image or archive", location)
+	}
+
+	watcher, err := fsnotify.NewWatcher()
+	if err != nil {
+		return err
+	}
+	defer watcher.Close()
+	if err := watcher.Add(location); err != nil {
+		return err
+	}
+
+	w := &dumpWatcher{location: location, watcher: watcher}
+	w.sync(ctx, nil)
+
+	pending := make(map[string]bool) // title directories to check, "" for all
+	var quiet, deadline <-chan time.Time
+	poll := time.NewTicker(watchPoll)
+	defer poll.Stop()
+	for {
+		select {
+		case <-ctx.Done():
+			return nil
+		case event := <-watcher.Events:
+			w.note(event.Name, pending)
+			quiet = time.After(watchDebounce)
+			if deadline == nil {
+				deadline = time.After(watchMaxDelay)
+			}
+			continue
+		case err := <-watcher.Errors:
+			if !errors.Is(err, fsnotify.ErrEventOverflow) {
+				fmt.Fprintf(statusOut, "Watch error: %v\n", err)
+				continue
+			}
+			// Events were dropped, compare everything
+			pending[""] = true
+			quiet = time.After(watchDebounce)
+			continue
+		case <-poll.C:
+			if len(pending) > 0 || w.rootState() == w.state {
+				continue
+			}
+			pending[""] = true
+		case <-quiet:
+		case <-deadline:
+		}
+
+		quiet, deadline = nil, nil
+		dirs := pending
+		pending = make(map[string]bool)
+		w.sync(ctx, dirs)
+	}
+}
+
+// note adds the title directory an event under name belongs to to pending.
+// Anything outside a title directory means the roots themselves changed.
+func (w *dumpWatcher) note(name string, pending map[string]bool) {
+	if w.src != nil {
+		if rel, err := filepath.Rel(w.src.dir, name); err == nil {
+			rel = filepath.ToSlash(rel)
+			for _, root := range w.roots {
+				if titleDir, ok := titleDirOf(root.dir, rel); ok {
+					pending[titleDir] = true
+					return
+				}
+			}
+		}
+	}
+	pending[""] = true
+}
+
+// titleDirOf returns the title directory directly under root that name, a
+// slash separated path in the dump, lies in. Both may be ".", for a dump
+// whose folder is the TDATA root itself.
+func titleDirOf(root, name string) (string, bool) {
+	for dir := name; dir != "." && dir != "/"; dir = path.Dir(dir) {
+		if path.Dir(dir) == root {
+			return dir, len(path.Base(dir)) == 8
+		}
+	}
+	return "", false
+}
+
+// sync fingerprints the title directories in dirs, or all of them if dirs
+// is nil or holds "", and scans those that are new or changed.
+func (w *dumpWatcher) sync(ctx context.Context, dirs map[string]bool) {
+	full := dirs == nil || dirs[""]
+	if full && !w.openRoots() {
+		return
+	}
+	defer func() { w.state = w.rootState() }()
+
+	var scan []scanRoot
+	total := 0
+	for _, root := range w.roots {
+		var candidates []string
+		if full {
+			listed, err := listTitleDirs(w.src.fsys, root.dir)
+			if err != nil {
+				fmt.Fprintf(statusOut, "Error listing %s: %v\n", w.src.displayPath(root.dir), err)
+				continue
+			}
+			w.watchDir(root.dir)
+			seen := make(map[string]bool, len(listed))
+			for _, dir := range listed {
+				seen[dir] = true
+			}
+			for dir := range w.fingerprints {
+				if path.Dir(dir) == root.dir && !seen[dir] {
+					delete(w.fingerprints, dir)
+				}
+			}
+			candidates = listed
+		} else {
+			for dir := range dirs {
+				if path.Dir(dir) == root.dir {
+					candidates = append(candidates, dir)
+				}
+			}
+			sort.Strings(candidates)
+		}
+
+		var changed []string
+		for _, dir := range candidates {
+			fingerprint, err := titleFingerprint(w.src.fsys, dir)
+			if err != nil {
+				// Removed, or the drive went away
+				delete(w.fingerprints, dir)
+				continue
+			}
+			if old, ok := w.fingerprints[dir]; ok && old == fingerprint {
+				continue
+			}
+			w.fingerprints[dir] = fingerprint
+			w.watchTitleDir(dir)
+			changed = append(changed, dir)
+		}
+		if len(changed) > 0 {
+			root.titleDirs = changed
+			scan = append(scan, root)
+			total += len(changed)
+		}
+	}
+	if len(scan) == 0 {
+		return
+	}
+
+	fmt.Fprintf(statusOut, "Scanning %d new or changed title directories in %s...\n", total, w.src.display)
+	if err := runScan(ctx, w.src, scan); err != nil && ctx.Err() == nil {
+		fmt.Fprintf(statusOut, "ERROR: %v\n", err)
+	}
+}
+
+// openRoots (re)opens the dump and finds its roots. A different device at
+// location is a different drive, and everything on it is new.
+func (w *dumpWatcher) openRoots() bool {
+	src, err := openDump(w.location)
+	if err == nil {
+		w.roots, err = src.scanRoots()
+	}
+	if err != nil {
+		w.src, w.roots = nil, nil
+		if !w.waiting {
+			fmt.Fprintf(statusOut, "Waiting for %s in %s...\n", strings.Join(selectedRoots, " or "), w.location)
+			w.waiting = true
+		}
+		w.state = w.rootState()
+		return false
+	}
+	w.waiting = false
+	if w.src == nil || w.src.device != src.device {
+		w.fingerprints = make(map[string]uint64)
+	}
+	w.src = src
+	return true
+}
+
+// watchDir watches name, a directory inside the dump. Watches vanish with
+// their directory, and adding one twice is harmless.
+func (w *dumpWatcher) watchDir(name string) {
+	w.watcher.Add(w.src.displayPath(name))
+}
+
+// watchTitleDir watches everything titleFingerprint looks at, plus the
+// content folders, whose contentmeta.xbx processDLCContent checks.
+func (w *dumpWatcher) watchTitleDir(dir string) {
+	w.watchDir(dir)
+	entries, _ := fs.ReadDir(w.src.fsys, dir)
+	dlc, updates := titleSubDirs(dir, entries)
+	for _, sub := range []string{dlc, updates} {
+		if sub != "" {
+			w.watchDir(sub)
+		}
+	}
+	if dlc == "" {
+		return
+	}
+	entries, _ = fs.ReadDir(w.src.fsys, dlc)
+	for _, entry := range entries {
+		if entry.IsDir() {
+			w.watchDir(path.Join(dlc, entry.Name()))
+		}
+	}
+}
+
+// rootState summarises the device at location and the listings of the
+// selected roots, so polling can tell when a drive was swapped without
+// fingerprinting every title directory.
+func (w *dumpWatcher) rootState() uint64 {
+	h := fnv.New64a()
+	var buf [8]byte
+	h.Write([]byte(deviceID(w.location)))
+
+	src, err := openDump(w.location)
+	if err != nil {
+		return h.Sum64()
+	}
+	for _, name := range selectedRoots {
+		dir, err := src.findRoot(name)
+		if err != nil {
+			continue
+		}
+		h.Write([]byte(dir))
+		entries, _ := fs.ReadDir(src.fsys, dir)
+		for _, entry := range entries {
+			h.Write([]byte(entry.Name()))
+			if info, err := entry.Info(); err == nil {
+				binary.LittleEndian.PutUint64(buf[:], uint64(info.ModTime().UnixNano()))
+				h.Write(buf[:])
+			}
+		}
+	}
+	return h.Sum64()
+}
+
+// listTitleDirs lists the potential title directories under dir the way
+// walkTitleTree finds them.
+func listTitleDirs(fsys fs.FS, dir string) ([]string, error) {
+	entries, err := fs.ReadDir(fsys, dir)
+	if err != nil {
+		return nil, err
+	}
+	var dirs []string
+	for _, d := range entries {
+		if !d.IsDir() {
+			continue
+		}
+		name := path.Join(dir, d.Name())
+		if len(d.Name()) != 8 {
+			nested, err := listTitleDirs(fsys, name)
+			if err != nil {
+				return nil, err
+			}
+			dirs = append(dirs, nested...)
+			continue
+		}
+		dirs = append(dirs, name)
+	}
+	return dirs, nil
+}
@@ -0,0 +1,28 @@
+package main
+
+import "testing"
+
+func TestTitleDirOf(t *testing.T) {
+	tests := []struct {
+		root, name string
+		want       string
+		ok         bool
+	}{
+		{"TDATA", "TDATA/4d530004/$u/default.xbe", "TDATA/4d530004", true},
+		{"TDATA", "TDATA/4d530004", "TDATA/4d530004", true},
+		{"TDATA", "TDATA", "", false},
+		{"TDATA", "TDATA/fffe0000x", "", false},
+		{"TDATA", "UDATA/4d530004", "", false},
+		{"E/TDATA", "E/TDATA/4d530004/$c", "E/TDATA/4d530004", true},
+		{".", "4d530004/$c/4d53000400000001/contentmeta.xbx", "4d530004", true},
+		{".", "4d530004", "4d530004", true},
+		{".", ".", "", false},
+		{".", "../4d530004", "", false},
+	}
+	for _, test := range tests {
+		got, ok := titleDirOf(test.root, test.name)
+		if ok != test.ok || ok && got != test.want {
+			t.Errorf("titleDirOf(%q, %q) = %q, %v; want %q, %v", test.root, test.name, got, ok, test.want, test.ok)
+		}
+	}
+}